@@ -2,8 +2,19 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <cmath>
+#include <type_traits>
+
+//the input and output go straight to the file descriptors, without iostream
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -15,6 +26,18 @@ using namespace std;
 #define THRUST_MINIMUM 0
 #define THRUST_MAXIMUM 100
 
+//log levels: records above LOG_LEVEL are removed at compile time and their arguments are not evaluated
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+//records of a turn are kept in a ring buffer of this size and written once the output is sent
+#define LOG_BUFFER_SIZE 4096
+
 #define PI 3.14159265f
 #define DEG2RAD(angle) ((angle) * PI / 180.0f)
 #define RAD2DEG(angle) ((angle) * 180.0f / PI)
@@ -25,6 +48,269 @@ float clip(float _n, float _lower, float _upper)
 	return max(_lower, min(_n, _upper));
 }
 
+#pragma region Logger
+//Records are one line each: level, event, then key=value fields. They are formatted into a fixed ring buffer
+//and written to stderr in one go by Flush, when the oldest records have been overwritten a line tells how much was lost
+class Logger
+{
+private:
+	char m_buffer[LOG_BUFFER_SIZE];
+	size_t m_size = 0; //bytes recorded since the last flush, the buffer holds the last LOG_BUFFER_SIZE of them
+
+	void Append(char _c) { m_buffer[m_size++ % LOG_BUFFER_SIZE] = _c; }
+	void Append(const char* _text)
+	{
+		while (*_text)
+		{
+			Append(*_text++);
+		}
+	}
+	void AppendValue(const char* _text) { Append(_text); }
+	template<typename T>
+	void AppendValue(const T& _value)
+	{
+		char text[32];
+		if (is_floating_point<T>::value)
+		{
+			snprintf(text, sizeof(text), "%.3f", (double)_value);
+		}
+		else
+		{
+			snprintf(text, sizeof(text), "%lld", (long long)_value);
+		}
+		Append(text);
+	}
+	void AppendFields() {}
+	template<typename T, typename... Fields>
+	void AppendFields(const char* _key, const T& _value, const Fields&... _fields)
+	{
+		Append(' ');
+		Append(_key);
+		Append('=');
+		AppendValue(_value);
+		AppendFields(_fields...);
+	}
+public:
+	static Logger& Get()
+	{
+		static Logger logger;
+		return logger;
+	}
+	template<typename... Fields>
+	void Record(const char* _level, const char* _event, const Fields&... _fields)
+	{
+		Append(_level);
+		Append(' ');
+		Append(_event);
+		AppendFields(_fields...);
+		Append('\n');
+	}
+	void Flush()
+	{
+		if (m_size > LOG_BUFFER_SIZE)
+		{
+			const size_t start = m_size % LOG_BUFFER_SIZE;
+			char header[64];
+			snprintf(header, sizeof(header), "WARN log dropped=%lld\n", (long long)(m_size - LOG_BUFFER_SIZE));
+			cerr.write(header, strlen(header));
+			cerr.write(m_buffer + start, LOG_BUFFER_SIZE - start);
+			cerr.write(m_buffer, start);
+		}
+		else
+		{
+			cerr.write(m_buffer, m_size);
+		}
+		m_size = 0;
+	}
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::Get().Record("ERROR", __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) Logger::Get().Record("WARN", __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::Get().Record("INFO", __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::Get().Record("DEBUG", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_LEVEL > LOG_LEVEL_NONE
+#define LOG_FLUSH() Logger::Get().Flush()
+#else
+#define LOG_FLUSH() ((void)0)
+#endif
+#pragma endregion Logger
+
+#pragma region InputOutput
+inline long ReadDescriptor(int _fd, char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+	return _read(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)read(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+inline long WriteDescriptor(int _fd, const char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+	return _write(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)write(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+//the two lines of a turn of the single pod protocol
+struct TurnInput
+{
+	int x, y, nextCheckpointX, nextCheckpointY, nextCheckpointDist, nextCheckpointAngle;
+	int opponentX, opponentY;
+};
+
+//Reads the referee input in large blocks and parses the integers in place, with no locale and no stdio synchronization.
+//The input of a whole turn usually arrives with a single read
+class InputReader
+{
+private:
+	static constexpr int BUFFER_SIZE = 1 << 16;
+	int m_fd;
+	vector<char> m_buffer;
+	const char* m_current = nullptr;
+	const char* m_end = nullptr;
+
+	bool Refill();
+public:
+	InputReader(int _fd = 0) : m_fd(_fd), m_buffer(BUFFER_SIZE) {}
+	//false at the end of the input
+	bool ReadInt(int& _value);
+	bool ReadTurn(TurnInput& _turn);
+};
+
+bool InputReader::Refill()
+{
+	long size;
+	do
+	{
+		size = ReadDescriptor(m_fd, m_buffer.data(), BUFFER_SIZE);
+	} while (size < 0 && errno == EINTR);
+	if (size <= 0)
+	{
+		return false;
+	}
+	m_current = m_buffer.data();
+	m_end = m_current + size;
+	return true;
+}
+
+bool InputReader::ReadInt(int& _value)
+{
+	//skip the separators
+	while (true)
+	{
+		if (m_current == m_end && !Refill())
+		{
+			return false;
+		}
+		if (*m_current == '-' || (unsigned int)(*m_current - '0') < 10u)
+		{
+			break;
+		}
+		m_current++;
+	}
+	const bool isNegative = *m_current == '-';
+	m_current += isNegative;
+	//a number can be cut by the end of the buffer
+	int value = 0;
+	do
+	{
+		while (m_current < m_end && (unsigned int)(*m_current - '0') < 10u)
+		{
+			value = value * 10 + (*m_current++ - '0');
+		}
+	} while (m_current == m_end && Refill());
+	_value = isNegative ? -value : value;
+	return true;
+}
+
+bool InputReader::ReadTurn(TurnInput& _turn)
+{
+	return ReadInt(_turn.x) && ReadInt(_turn.y) && ReadInt(_turn.nextCheckpointX) && ReadInt(_turn.nextCheckpointY)
+		&& ReadInt(_turn.nextCheckpointDist) && ReadInt(_turn.nextCheckpointAngle) && ReadInt(_turn.opponentX) && ReadInt(_turn.opponentY);
+}
+
+//The output of a turn is formatted in one buffer and sent with a single write on Flush
+class OutputWriter
+{
+private:
+	int m_fd;
+	string m_buffer;
+public:
+	OutputWriter(int _fd = 1) : m_fd(_fd) { m_buffer.reserve(256); }
+	void Write(const char* _text) { m_buffer += _text; }
+	void Write(char _c) { m_buffer += _c; }
+	void Write(int _value);
+	//same text as the default formatting of an ostream: %g, 6 significant digits
+	void Write(float _value);
+	void Flush();
+};
+
+void OutputWriter::Write(int _value)
+{
+	char digits[12];
+	int count = 0;
+	unsigned int magnitude = _value < 0 ? 0u - (unsigned int)_value : (unsigned int)_value;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (_value < 0)
+	{
+		m_buffer += '-';
+	}
+	while (count > 0)
+	{
+		m_buffer += digits[--count];
+	}
+}
+
+void OutputWriter::Write(float _value)
+{
+	char text[32];
+	snprintf(text, sizeof(text), "%g", (double)_value);
+	m_buffer += text;
+}
+
+void OutputWriter::Flush()
+{
+	int written = 0;
+	while (written < (int)m_buffer.size())
+	{
+		const long size = WriteDescriptor(m_fd, m_buffer.data() + written, (int)m_buffer.size() - written);
+		if (size < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (size <= 0)
+		{
+			break;
+		}
+		written += size;
+	}
+	m_buffer.clear();
+}
+#pragma endregion InputOutput
+
 #pragma region Vector2Class
 class Vector2
 {
@@ -191,29 +477,28 @@ int main()
 	bool isBoosting = false;
 	bool hasUsedBoost = false;
 	CheckpointManager checkpointManager;
+	InputReader input;
+	OutputWriter output;
+	TurnInput turn;
 
 	// game loop
-	while (1)
+	while (input.ReadTurn(turn))
 	{
-		int x;
-		int y;
-		int nextCheckpointX; // x position of the next check point
-		int nextCheckpointY; // y position of the next check point
-		int nextCheckpointDist; // distance to the next checkpoint
-		int nextCheckpointAngle; // angle between your pod orientation and the direction of the next checkpoint
-		int opponentX;
-		int opponentY;
-		cin >> x >> y >> nextCheckpointX >> nextCheckpointY >> nextCheckpointDist >> nextCheckpointAngle;
-		cin.ignore();
-		cin >> opponentX >> opponentY;
-		cin.ignore();
+		int x = turn.x;
+		int y = turn.y;
+		int nextCheckpointX = turn.nextCheckpointX; // x position of the next check point
+		int nextCheckpointY = turn.nextCheckpointY; // y position of the next check point
+		int nextCheckpointDist = turn.nextCheckpointDist; // distance to the next checkpoint
+		int nextCheckpointAngle = turn.nextCheckpointAngle; // angle between your pod orientation and the direction of the next checkpoint
+		int opponentX = turn.opponentX;
+		int opponentY = turn.opponentY;
 		int opponentDist = (int)sqrt((double)pow((opponentX - x), 2) + (double)pow((opponentY - y), 2));
 		checkpointManager.AddNewCheckpoint(nextCheckpointX, nextCheckpointY);
 		checkpointManager.CheckBiggestDistance(nextCheckpointDist);
 		thrust = 100.0f;
 		if (abs(nextCheckpointAngle) < 5)
 		{
-			cerr << "Small angle" << endl;
+			LOG_DEBUG("small_angle", "angle", nextCheckpointAngle);
 			thrust = THRUST_MAXIMUM;
 			//conditions for the boost
 			if (checkpointManager.IsFirstLapOver() && hasUsedBoost == false && nextCheckpointDist > 5000)
@@ -265,14 +550,27 @@ int main()
 
 		if (isBoosting == true)
 		{
-			cout << nextCheckpointX << " " << nextCheckpointY << " " << "BOOST" << endl;
+			output.Write(nextCheckpointX);
+			output.Write(' ');
+			output.Write(nextCheckpointY);
+			output.Write(' ');
+			output.Write("BOOST\n");
 			isBoosting = false;
 		}
 		else
 		{
 			//make sure that the thrust remains between 0 and 100
 			thrust = clip(thrust, 0, 100); 
-			cout << nextCheckpointX << " " << nextCheckpointY << " " << (int)thrust << " " << thrust << endl;
+			output.Write(nextCheckpointX);
+			output.Write(' ');
+			output.Write(nextCheckpointY);
+			output.Write(' ');
+			output.Write((int)thrust);
+			output.Write(' ');
+			output.Write(thrust);
+			output.Write('\n');
 		}
+		output.Flush();
+		LOG_FLUSH();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,327 @@
+//CorpusBenchmark: search quality per millisecond of the search engines on recorded race positions.
+//"build" turns traces recorded with "GoldToLegend --record FILE" into a corpus file of positions, each with the score of a long reference search.
+//"run" maps the corpus and searches every position from a new engine (the hill climbing unless --engine NAME) with fixed time budgets, then writes one key=value line per budget:
+//generations per turn, simulations (candidates scored) per second, and the final RateSolution score relative to the reference.
+//POSIX only. Build: g++ -std=c++17 -O2 -pthread CorpusBenchmark.cpp -o corpus_benchmark
+//Usage: corpus_benchmark build CORPUS [--reference-generations N] [--jobs J] TRACE...
+//       corpus_benchmark run CORPUS [--budgets 5,20,75] [--positions N] [--engine NAME]
+//Traces of many games: for s in $(seq 100); do ./referee --quiet --seed $s "./GoldToLegend --record trace$s.bin" ./GoldToLegend; done
+#define RENDUCODE_NO_MAIN
+#include "GoldToLegend.cpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CORPUS_MAGIC "RCC1"
+#define CORPUS_MAX_CHECKPOINTS 8
+#define REFERENCE_GENERATIONS 100000 //a few times the generations of a 75 ms turn
+#define REFERENCE_SEED 7
+
+//the corpus is a header followed by fixed size positions, all 32-bit fields so that it can be used in place once mapped
+struct CorpusHeader
+{
+	char magic[4];
+	uint32_t count;
+	uint32_t referenceGenerations;
+	uint32_t referenceSeed;
+};
+
+struct CorpusPod
+{
+	int32_t x, y, speedX, speedY, angle;
+	int32_t nextCheckpointId, totalCheckpointsPassed, shieldCooldown, hasBoosted;
+};
+
+struct CorpusPosition
+{
+	int32_t laps;
+	int32_t checkpointCount;
+	int32_t checkpoints[CORPUS_MAX_CHECKPOINTS][2];
+	CorpusPod pods[POD_COUNT];
+	int32_t referenceScore;
+
+	void SetTrack(Simulation& _simulation) const;
+	void GetState(RaceState& _state) const;
+};
+static_assert(sizeof(CorpusHeader) == 16 && sizeof(CorpusPosition) == 4 * (3 + 2 * CORPUS_MAX_CHECKPOINTS + 9 * POD_COUNT), "corpus records must not be padded");
+
+void CorpusPosition::SetTrack(Simulation& _simulation) const
+{
+	vector<Vector2> track(checkpointCount);
+	for (int c = 0; c < checkpointCount; c++)
+	{
+		track[c] = Vector2((float)checkpoints[c][0], (float)checkpoints[c][1]);
+	}
+	_simulation.SetCheckpoints(track, laps);
+}
+
+void CorpusPosition::GetState(RaceState& _state) const
+{
+	vector<Pod> podList(POD_COUNT);
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		const CorpusPod& pod = pods[i];
+		podList[i].position = Vector2((float)pod.x, (float)pod.y);
+		podList[i].speed = Vector2((float)pod.speedX, (float)pod.speedY);
+		podList[i].angle = pod.angle;
+		podList[i].nextCheckpointId = pod.nextCheckpointId;
+		podList[i].totalCheckpointsPassed = pod.totalCheckpointsPassed;
+		podList[i].shieldCooldown = pod.shieldCooldown;
+		podList[i].hasBoosted = pod.hasBoosted != 0;
+	}
+	_state.Load(podList);
+}
+
+//the positions seen by the bot, rebuilt like Replayer.cpp does but with the recorded decisions instead of a new search
+bool ReadTracePositions(const char* _path, vector<CorpusPosition>& _positions)
+{
+	TraceReader reader;
+	TraceHeader header;
+	if (!reader.Open(_path) || !reader.ReadHeader(header) || header.checkpoints.size() > CORPUS_MAX_CHECKPOINTS)
+	{
+		return false;
+	}
+	CorpusPosition position = {};
+	position.laps = header.laps;
+	position.checkpointCount = (int)header.checkpoints.size();
+	for (int c = 0; c < position.checkpointCount; c++)
+	{
+		position.checkpoints[c][0] = (int)header.checkpoints[c].GetX();
+		position.checkpoints[c][1] = (int)header.checkpoints[c].GetY();
+	}
+	Vector2 firstCheckpoint = header.checkpoints[1];
+	vector<Pod> pods(POD_COUNT);
+	TraceTurn turn;
+	for (int step = 0; reader.ReadTurn(turn); step++)
+	{
+		UpdatePods(pods, turn.input, step == 0, firstCheckpoint);
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			position.pods[i] = { (int)pods[i].position.GetX(), (int)pods[i].position.GetY(), (int)pods[i].speed.GetX(), (int)pods[i].speed.GetY(),
+				pods[i].angle, pods[i].nextCheckpointId, pods[i].totalCheckpointsPassed, pods[i].shieldCooldown, pods[i].hasBoosted ? 1 : 0 };
+		}
+		_positions.push_back(position);
+
+		Solution decision;
+		for (int i = 0; i < 2; i++)
+		{
+			decision[0][i].SetUseShield((turn.moves[i] & Move::SHIELD_BIT) != 0);
+			decision[0][i].SetUseBoost((turn.moves[i] & Move::BOOST_BIT) != 0);
+		}
+		UpdateShieldAndBoostForNextTurn(decision, pods);
+	}
+	return true;
+}
+
+//score of a search with a fixed number of generations, it does not depend on the machine
+int ComputeReferenceScore(const CorpusPosition& _position, int _generations, unsigned int _seed)
+{
+	Simulation simulation;
+	_position.SetTrack(simulation);
+	RaceState state;
+	_position.GetState(state);
+	Solver solver(&simulation, _seed);
+	TimeBudget budget;
+	budget.StartTurn(INT_MAX);
+	return solver.Solve(state, budget, _generations).score;
+}
+
+int Build(const string& _corpusPath, const vector<string>& _tracePaths, int _referenceGenerations, int _jobs)
+{
+	vector<CorpusPosition> positions;
+	for (const string& path : _tracePaths)
+	{
+		if (!ReadTracePositions(path.c_str(), positions))
+		{
+			fprintf(stderr, "cannot read the trace %s\n", path.c_str());
+			return 1;
+		}
+	}
+
+	atomic<int> nextPosition{ 0 };
+	auto worker = [&]()
+	{
+		for (int p = nextPosition++; p < (int)positions.size(); p = nextPosition++)
+		{
+			positions[p].referenceScore = ComputeReferenceScore(positions[p], _referenceGenerations, REFERENCE_SEED);
+		}
+	};
+	vector<thread> workers;
+	for (int j = 0; j < _jobs; j++)
+	{
+		workers.emplace_back(worker);
+	}
+	for (thread& thread : workers)
+	{
+		thread.join();
+	}
+	//a race already decided by the reference tells nothing about the search
+	positions.erase(remove_if(positions.begin(), positions.end(), [](const CorpusPosition& p)
+		{ return p.referenceScore == INT_MAX || p.referenceScore == INT_MIN; }), positions.end());
+
+	FILE* file = fopen(_corpusPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "cannot write %s\n", _corpusPath.c_str());
+		return 1;
+	}
+	CorpusHeader header;
+	memcpy(header.magic, CORPUS_MAGIC, 4);
+	header.count = (uint32_t)positions.size();
+	header.referenceGenerations = (uint32_t)_referenceGenerations;
+	header.referenceSeed = REFERENCE_SEED;
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(positions.data(), sizeof(CorpusPosition), positions.size(), file);
+	fclose(file);
+	printf("corpus positions=%d traces=%d reference_generations=%d\n", (int)positions.size(), (int)_tracePaths.size(), _referenceGenerations);
+	return 0;
+}
+
+//read-only mapping of a corpus file
+class CorpusFile
+{
+private:
+	void* m_data = MAP_FAILED;
+	size_t m_size = 0;
+public:
+	~CorpusFile()
+	{
+		if (m_data != MAP_FAILED)
+		{
+			munmap(m_data, m_size);
+		}
+	}
+	bool Open(const char* _path)
+	{
+		const int fd = open(_path, O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat status;
+		if (fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(CorpusHeader))
+		{
+			m_size = (size_t)status.st_size;
+			m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);
+		return m_data != MAP_FAILED && memcmp(GetHeader().magic, CORPUS_MAGIC, 4) == 0
+			&& m_size >= sizeof(CorpusHeader) + GetHeader().count * sizeof(CorpusPosition);
+	}
+	const CorpusHeader& GetHeader() const { return *(const CorpusHeader*)m_data; }
+	const CorpusPosition& operator[](int _i) const { return ((const CorpusPosition*)((const char*)m_data + sizeof(CorpusHeader)))[_i]; }
+};
+
+int Run(const string& _corpusPath, const vector<int>& _budgets, int _positionCount, SearchEngineType _engine)
+{
+	CorpusFile corpus;
+	if (!corpus.Open(_corpusPath.c_str()))
+	{
+		fprintf(stderr, "%s is not a corpus\n", _corpusPath.c_str());
+		return 1;
+	}
+	const int count = (int)corpus.GetHeader().count;
+	const int positionCount = _positionCount > 0 ? min(_positionCount, count) : count;
+	printf("corpus positions=%d searched=%d reference_generations=%u engine=%s\n", count, positionCount, corpus.GetHeader().referenceGenerations,
+		SEARCH_ENGINE_NAMES[_engine]);
+	for (int milliseconds : _budgets)
+	{
+		//one budget for all the positions, its cost estimate carries over like during a game
+		TimeBudget budget;
+		long long generations = 0;
+		double seconds = 0.0;
+		double scoreDelta = 0.0;
+		int reached = 0;
+		for (int s = 0; s < positionCount; s++)
+		{
+			//evenly spread over the corpus when only a part is searched
+			const int p = (int)((long long)s * count / positionCount);
+			const CorpusPosition& position = corpus[p];
+			Simulation simulation;
+			position.SetTrack(simulation);
+			RaceState state;
+			position.GetState(state);
+			unique_ptr<SearchEngine> solver = CreateSearchEngine(_engine, &simulation, SOLVER_SEED + p);
+
+			const auto start = chrono::steady_clock::now();
+			//the whole budget is searched, there is no output to reserve time for
+			budget.StartTurn(milliseconds, 0.0);
+			const int score = solver->Solve(state, budget).score;
+			budget.EndTurn();
+			seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			generations += solver->GetGenerations();
+			scoreDelta += (double)score - position.referenceScore;
+			reached += score >= position.referenceScore ? 1 : 0;
+		}
+		//the candidates are scored once when the turn starts, then SOLUTIONS_COUNT new ones per generation
+		const double simulations = (double)(generations + positionCount) * SOLUTIONS_COUNT;
+		printf("budget ms=%d positions=%d generations_per_turn=%.1f simulations_per_second=%.0f score_delta=%.1f reached_reference=%.3f turn_ms=%.3f\n",
+			milliseconds, positionCount, (double)generations / positionCount, simulations / max(seconds, 1e-9),
+			scoreDelta / positionCount, (double)reached / positionCount, seconds * 1000.0 / positionCount);
+		fflush(stdout);
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3 || (strcmp(argv[1], "build") != 0 && strcmp(argv[1], "run") != 0))
+	{
+		fprintf(stderr, "usage: %s build CORPUS [--reference-generations N] [--jobs J] TRACE...\n"
+			"       %s run CORPUS [--budgets 5,20,75] [--positions N] [--engine NAME]\n", argv[0], argv[0]);
+		return 2;
+	}
+	const bool isBuild = strcmp(argv[1], "build") == 0;
+	const string corpusPath = argv[2];
+	int referenceGenerations = REFERENCE_GENERATIONS;
+	int jobs = max(1, (int)thread::hardware_concurrency());
+	vector<int> budgets = { 5, 20, 75 };
+	int positionCount = 0;
+	SearchEngineType engine = SEARCH_ENGINE;
+	vector<string> tracePaths;
+	for (int a = 3; a < argc; a++)
+	{
+		const string argument = argv[a];
+		if (isBuild && argument == "--reference-generations" && a + 1 < argc)
+		{
+			referenceGenerations = atoi(argv[++a]);
+		}
+		else if (isBuild && argument == "--jobs" && a + 1 < argc)
+		{
+			jobs = max(1, atoi(argv[++a]));
+		}
+		else if (!isBuild && argument == "--budgets" && a + 1 < argc)
+		{
+			budgets.clear();
+			const string list = argv[++a];
+			for (size_t start = 0; start < list.size(); )
+			{
+				const size_t end = min(list.find(',', start), list.size());
+				budgets.push_back(max(1, atoi(list.substr(start, end - start).c_str())));
+				start = end + 1;
+			}
+		}
+		else if (!isBuild && argument == "--positions" && a + 1 < argc)
+		{
+			positionCount = atoi(argv[++a]);
+		}
+		else if (!isBuild && argument == "--engine" && a + 1 < argc && FindSearchEngine(argv[a + 1]) != ENGINE_COUNT)
+		{
+			engine = FindSearchEngine(argv[++a]);
+		}
+		else if (isBuild && argument.compare(0, 2, "--") != 0)
+		{
+			tracePaths.push_back(argument);
+		}
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+	if (isBuild)
+	{
+		return Build(corpusPath, tracePaths, referenceGenerations, jobs);
+	}
+	return Run(corpusPath, budgets, positionCount, engine);
+}
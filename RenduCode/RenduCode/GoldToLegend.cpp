@@ -1,19 +1,146 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cerrno>
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+//the time budget reads the time stamp counter when the compiler exposes it
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TSC_TIMER 1
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TSC_TIMER 1
+#else
+#define TSC_TIMER 0
+#endif
+
+//the input and output go straight to the file descriptors, without iostream
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+//the pondering thread gets the idle scheduling class where it exists
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 using namespace std;
 
 #define TIMEOUT_FIRST_TURN 500
 #define TIMEOUT 75
+//milliseconds of the timeout left unused by the solver: the wake-up of the bot and the read of the output by the referee, which the bot cannot measure.
+//The stalls of the host and the output time are measured every turn and added to it, see TimeBudget
+#define TIMEOUT_RESERVE_MINIMUM 2.0
+//reserve of the first turn, before any stall has been measured
+#define TIMEOUT_RESERVE_START 8.0
+//turns of stall measures kept, and number of the longest ones the reserve does not cover
+#define STALL_HISTORY_TURNS 100
+#define STALL_IGNORED_TURNS 2
+//weight of the last measure in the moving estimate of the cost of a generation
+#define BUDGET_COST_SMOOTHING 0.1
+//the next generations are started only if they fit with this many deviations above their mean cost
+#define BUDGET_COST_DEVIATIONS 4.0
 
 #define SIMULATION_TURNS 4
 #define SOLUTIONS_COUNT 6
 
+//defaults of the parameters that can be changed at run time, see Parameters.
+//A header exported by Tuner.cpp replaces them when it is included first (g++ -include TunedParameters.h)
+#ifndef AHEAD_BIAS
+#define AHEAD_BIAS 2.0f //being ahead is better than blocking the opponent
+#endif
+//chances of each value of a move to be the one changed by a mutation.
+//The evaluation overrates the shield: with a shield weight of 1 the pods shield on most turns and lose their races
+#ifndef MUTATION_ROTATION_WEIGHT
+#define MUTATION_ROTATION_WEIGHT 6
+#endif
+#ifndef MUTATION_THRUST_WEIGHT
+#define MUTATION_THRUST_WEIGHT 5
+#endif
+#ifndef MUTATION_SHIELD_WEIGHT
+#define MUTATION_SHIELD_WEIGHT 0
+#endif
+#ifndef MUTATION_BOOST_WEIGHT
+#define MUTATION_BOOST_WEIGHT 0
+#endif
+#ifndef FIRST_TURN_BOOST_DISTANCE
+#define FIRST_TURN_BOOST_DISTANCE 3000.0f //the pods boost on the first turn when the first checkpoint is at least this far
+#endif
+
+//island model: independent populations evolved on SOLVER_THREADS threads, exchanging their best solution every MIGRATION_GENERATIONS generations.
+//1 island and 1 thread is the plain single population solver. "--threads N" and "--islands N" change them at startup
+#define SOLVER_THREADS 1
+#define SOLVER_ISLANDS SOLVER_THREADS
+#define MIGRATION_GENERATIONS 16
+#define SOLVER_SEED 100
+
+//search run by every island, see SearchEngineType. "--engine NAME" changes it at startup
+#define SEARCH_ENGINE ENGINE_HILL_CLIMBING
+//simulated annealing: temperature in score points at the start and at the end of a turn, and the length assumed for the first turn
+#define ANNEALING_START_TEMPERATURE 1000.0f
+#define ANNEALING_END_TEMPERATURE 10.0f
+#define ANNEALING_FIRST_GENERATIONS 5000
+//genetic algorithm: solutions kept between generations and solutions drawn for each tournament selection
+#define GENETIC_POPULATION (2 * SOLUTIONS_COUNT)
+#define GENETIC_TOURNAMENT_SIZE 2
+//random-restart hill climbing: generations without improvement before a climber restarts
+#define RESTART_PATIENCE 200
+//Smitsimax: weight of the exploration term of UCB, on scores normalized between 0 and 1, and nodes of each tree
+#define SMITSIMAX_EXPLORATION 0.5f
+#define SMITSIMAX_MAX_NODES (1 << 16)
+//exhaustive search: enumerated turns, 1 is 441 candidates and 2 is 194481 candidates, only affordable on the first turn
+#define EXHAUSTIVE_DEPTH 1
+//beam search: widest beam, and the length assumed for the first turn to choose its width
+#define BEAM_MAXIMUM_WIDTH 256
+#define BEAM_FIRST_GENERATIONS 20000
+
+//keep searching while waiting for the next input, against the state predicted for the move we played.
+//The pondered population is kept if our pods end up within PONDER_TOLERANCE of the prediction
+#define PONDERING 1
+#define PONDER_TOLERANCE 5.0f
+
+//the opponents follow a policy fitted during the game in the simulation of the searches (see OpponentModel), 0 makes them coast
+#define OPPONENT_MODEL 1
+#define OPPONENT_DRIFT_COMPENSATION 3.0f //turns of speed the opponents aim short of their checkpoint
+#define OPPONENT_BOOST_DISTANCE 5000.0f //distance to the checkpoint from which they boost until a boost is seen
+#define OPPONENT_FIT_SMOOTHING 0.1f //weight of the last observation in the fitted values
+#define OPPONENT_COLLISION_TOLERANCE 10.0f //change of speed across the facing of a pod that is a collision and not a rounding
+#define OPPONENT_CONTACT_DISTANCE 2000.0f //collisions closer than this to one of our pods may be shielded
+
+//log levels: records above LOG_LEVEL are removed at compile time and their arguments are not evaluated
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+//records of a turn are kept in a ring buffer of this size and written once the output is sent
+#define LOG_BUFFER_SIZE 4096
+
+#define POD_COUNT 4
+
+//candidates simulated together by the batch kernel: 2 AVX2 registers or 1 AVX-512 register per field
+#define BATCH_LANES 16
+//below this many candidates a turn is simulated one candidate at a time: a SIMD turn costs about as much as 3 scalar ones, whatever its lane count
+#define BATCH_MINIMUM_LANES 3
+
 #define THRUST_MAXIMUM 100
 #define THRUST_BOOST 650
 
@@ -31,6 +158,22 @@ using namespace std;
 #define PI 3.14159265f
 #define DEG2RAD(angle) ((angle) * PI / 180.0f)
 #define RAD2DEG(angle) ((angle) * 180.0f / PI)
+
+//The batch kernel is written with GCC vector extensions, one element per candidate.
+//It is instantiated for AVX-512 (16 lanes), AVX2 (8 lanes) and SSE2 (4 lanes), the best one is picked at run time.
+//Other compilers fall back to the scalar expert rules, one candidate after the other
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define BATCH_SIMD 1
+#define FORCE_INLINE __attribute__((always_inline)) inline
+template<int WIDTH>
+struct Lanes
+{
+	typedef float Float __attribute__((vector_size(4 * WIDTH)));
+	typedef int Int __attribute__((vector_size(4 * WIDTH)));
+};
+#else
+#define BATCH_SIMD 0
+#endif
 //function to clamp a float value
 float clip(float _n, float _lower, float _upper)
 {
@@ -51,9 +194,11 @@ public:
 	static Vector2 Normalize(const Vector2& _v);
 	static Vector2 Rotate(const Vector2& _v, float angle);
 	static float Distance(const Vector2& _v1, const Vector2& _v2);
+	static const Vector2& FromAngle(int _degrees);
+	static int GetClosestAngle(const Vector2& _direction);
 
-	Vector2(float _x, float _y) : m_x(_x), m_y(_y) {}
-	Vector2() : m_x(0.f), m_y(0.f) {}
+	constexpr Vector2(float _x, float _y) : m_x(_x), m_y(_y) {}
+	constexpr Vector2() : m_x(0.f), m_y(0.f) {}
 	~Vector2() = default;
 
 	bool operator == (const Vector2& _v) const;
@@ -62,8 +207,8 @@ public:
 	Vector2 operator *(const float _f);
 	Vector2 operator + (const Vector2& _v);
 
-	inline float GetX() { return m_x; }
-	inline float GetY() { return m_y; }
+	inline float GetX() const { return m_x; }
+	inline float GetY() const { return m_y; }
 };
 
 Vector2 operator*(float k, Vector2& _v)
@@ -74,11 +219,13 @@ Vector2 operator*(float k, Vector2& _v)
 Vector2 operator+=(Vector2& _v1, const Vector2& _v2)
 {
 	_v1 = _v1 + _v2;
+	return _v1;
 }
 
 Vector2 operator*=(Vector2& _v, float _f)
 {
 	_v = _f * _v;
+	return _v;
 }
 
 bool Vector2::operator==(const Vector2& _v) const
@@ -153,683 +300,4072 @@ Vector2 Vector2::operator+(const Vector2& _v)
 	Vector2 result(m_x + _v.m_x, m_y + _v.m_y);
 	return result;
 }
-#pragma endregion Vector2Class
-
-struct Pod
-{
-	Vector2 position;
-	Vector2 speed;
-	int angle = -1;
-
-	int nextCheckpointId = 0;
-	int totalCheckpointsPassed = 0;
-
-	bool hasBoosted = false;
-	int shieldCooldown = 0;
-
-	int score = 0;
-};
 
-void ManageShield(bool _isTurnedOn, Pod _pod)
+//Taylor series of sin and cos, only evaluated at compile time for _x in [-PI, PI]
+constexpr double ConstexprSin(double _x)
 {
-	if (_isTurnedOn)
+	double term = _x;
+	double sum = _x;
+	for (int n = 1; n < 20; n++)
 	{
-		_pod.shieldCooldown = SHIELD_COOLDOWN;
+		term *= -_x * _x / ((2 * n) * (2 * n + 1));
+		sum += term;
 	}
-	else if (_pod.shieldCooldown > 0)
+	return sum;
+}
+
+constexpr double ConstexprCos(double _x)
+{
+	double term = 1.0;
+	double sum = 1.0;
+	for (int n = 1; n < 20; n++)
 	{
-		_pod.shieldCooldown--;
+		term *= -_x * _x / ((2 * n - 1) * (2 * n));
+		sum += term;
 	}
+	return sum;
 }
 
-void UpdatePodInfo(Pod& _pod)
+//unit vector of every integer angle in degrees, built at compile time: pods only turn by whole degrees
+struct AngleTable
 {
-	int x, y, speedX, speedY, angle, nextCheckPointId;
-	cin >> x >> y >> speedX >> speedY >> angle >> nextCheckPointId;
-	cin.ignore();
-
-	_pod.position = Vector2((float)x, (float)y);
-	_pod.speed = Vector2((float)speedX, (float)speedY);
-	_pod.angle = angle;
-	//check if the pod has passed a checkpoint since the last turn
-	if (_pod.nextCheckpointId != nextCheckPointId)
+	Vector2 directions[360];
+	constexpr AngleTable() : directions()
 	{
-		_pod.totalCheckpointsPassed++;
+		for (int a = 0; a < 360; a++)
+		{
+			const double angleRad = (a <= 180 ? a : a - 360) * 3.14159265358979323846 / 180.0;
+			directions[a] = Vector2((float)ConstexprCos(angleRad), (float)ConstexprSin(angleRad));
+		}
 	}
-	_pod.nextCheckpointId = nextCheckPointId;
+};
+constexpr AngleTable ANGLE_TABLE{};
+
+//_degrees between -359 and 359, the range of the pod angles
+inline const Vector2& Vector2::FromAngle(int _degrees)
+{
+	return ANGLE_TABLE.directions[_degrees < 0 ? _degrees + 360 : _degrees];
 }
-#pragma region PhysicsFunctions
-float GetPodMass(const Pod& _pod)
+
+//integer angle in [0, 360[ whose direction is the closest to _direction
+int Vector2::GetClosestAngle(const Vector2& _direction)
 {
-	float mass = 1.0f;
-	//check if shield is active
-	if (_pod.shieldCooldown == SHIELD_COOLDOWN)
+	int closestAngle = 0;
+	float closestDot = -INFINITY;
+	for (int a = 0; a < 360; a++)
 	{
-		mass = 10.0f;
+		const float dot = Dot(_direction, ANGLE_TABLE.directions[a]);
+		if (dot > closestDot)
+		{
+			closestDot = dot;
+			closestAngle = a;
+		}
 	}
-	return mass;
+	return closestAngle;
 }
+#pragma endregion Vector2Class
 
-float TimeToCollision(Pod& _pod1, Pod& _pod2)
+#pragma region Logger
+//Records are one line each: level, event, then key=value fields. They are formatted into a fixed ring buffer
+//and written to stderr in one go by Flush, when the oldest records have been overwritten a line tells how much was lost
+class Logger
 {
-	//physics simulation to check if a collision is imminent
-	Vector2 positionDifference = _pod2.position - _pod1.position;
-	Vector2 speedDifference = _pod2.speed - _pod1.speed;
+private:
+	char m_buffer[LOG_BUFFER_SIZE];
+	size_t m_size = 0; //bytes recorded since the last flush, the buffer holds the last LOG_BUFFER_SIZE of them
+	mutex m_mutex; //records can come from the island and pondering threads
 
-	float a = Vector2::Dot(speedDifference, speedDifference);
-	if (a < EPSILON)
+	void Append(char _c) { m_buffer[m_size++ % LOG_BUFFER_SIZE] = _c; }
+	void Append(const char* _text)
 	{
-		return INFINITY;
+		while (*_text)
+		{
+			Append(*_text++);
+		}
 	}
-
-	float b = -2.0f * Vector2::Dot(positionDifference, speedDifference);
-	float c = Vector2::Dot(positionDifference, positionDifference) - 4.0f * pow(POD_RADIUS, 2);
-
-	float delta = b * b - 4.f * a * c;
-	if (delta < 0.0f)
+	void AppendValue(const char* _text) { Append(_text); }
+	template<typename T>
+	void AppendValue(const T& _value)
 	{
-		return INFINITY;
+		char text[32];
+		if (is_floating_point<T>::value)
+		{
+			snprintf(text, sizeof(text), "%.3f", (double)_value);
+		}
+		else
+		{
+			snprintf(text, sizeof(text), "%lld", (long long)_value);
+		}
+		Append(text);
 	}
-
-	float time = (b - sqrt(delta)) / (2.f * a);
-	if (time <= EPSILON)
+	void AppendFields() {}
+	template<typename T, typename... Fields>
+	void AppendFields(const char* _key, const T& _value, const Fields&... _fields)
 	{
-		return INFINITY;
+		Append(' ');
+		Append(_key);
+		Append('=');
+		AppendValue(_value);
+		AppendFields(_fields...);
 	}
-	return time;
-}
-
-void Rebounce(Pod& _podA, Pod& _podB)
-{
-	//calculate how the pods will rebounce after a collision
-	float massA = GetPodMass(_podA);
-	float massB = GetPodMass(_podB);
-
-	Vector2 positionDifference = (_podB.position - _podA.position);
-	float distance = Vector2::Distance(_podA.position, _podB.position);
-
-	Vector2 dirVec = positionDifference * (1.0f / distance);
-	Vector2 speedDifference = (_podB.speed - _podA.speed);
-
-	float mass = (massA * massB) / (massA + massB);
-	float dirDotSpeedDiff = Vector2::Dot(speedDifference, dirVec);
-
-	float impulse = -2.0f * mass * dirDotSpeedDiff;
-	impulse = clip(impulse, -REBOUNCE_MINIMUM_IMPULSE, REBOUNCE_MINIMUM_IMPULSE);
+public:
+	static Logger& Get()
+	{
+		static Logger logger;
+		return logger;
+	}
+	template<typename... Fields>
+	void Record(const char* _level, const char* _event, const Fields&... _fields)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		Append(_level);
+		Append(' ');
+		Append(_event);
+		AppendFields(_fields...);
+		Append('\n');
+	}
+	void Flush()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_size > LOG_BUFFER_SIZE)
+		{
+			const size_t start = m_size % LOG_BUFFER_SIZE;
+			char header[64];
+			snprintf(header, sizeof(header), "WARN log dropped=%lld\n", (long long)(m_size - LOG_BUFFER_SIZE));
+			cerr.write(header, strlen(header));
+			cerr.write(m_buffer + start, LOG_BUFFER_SIZE - start);
+			cerr.write(m_buffer, start);
+		}
+		else
+		{
+			cerr.write(m_buffer, m_size);
+		}
+		m_size = 0;
+	}
+};
 
-	_podA.speed += (-1.0f * massA) * impulse * dirVec;
-	_podB.speed += (1.0f * massB) * impulse * dirVec;
-}
-#pragma endregion PhysicsFunctions
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::Get().Record("ERROR", __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) Logger::Get().Record("WARN", __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::Get().Record("INFO", __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::Get().Record("DEBUG", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_LEVEL > LOG_LEVEL_NONE
+#define LOG_FLUSH() Logger::Get().Flush()
+#else
+#define LOG_FLUSH() ((void)0)
+#endif
+#pragma endregion Logger
 
-#pragma region BaseSimulationData
-struct Move
+#pragma region Parameters
+//Constants that can be changed at run time, for the tuner. A bot started with "--parameters FILE" (one "NAME VALUE" per line)
+//or "--set NAME=VALUE" uses these values instead of the defines of the same name, "--list-parameters" prints them with their range
+struct ParameterDefinition
 {
-	int rotation = 0; // between -ROTATION_MAXIMUM and ROTATION_MAXIMUM
-	int thrust = 0; //between 0 and THRUST_MAXIMUM
-	bool useBoost = false;
-	bool useShield = false;
+	const char* name;
+	float value; //the default value
+	float minimum;
+	float maximum;
+	bool isInteger;
 };
 
-class Turn
+enum ParameterId
 {
-private:
-	vector<Move> m_moves = vector<Move>(2);
-public:
-	Move& operator[](size_t m) { return m_moves[m]; }
-	const Move& operator[](size_t m) const { return m_moves[m]; }
+	PARAMETER_AHEAD_BIAS,
+	PARAMETER_MUTATION_ROTATION_WEIGHT,
+	PARAMETER_MUTATION_THRUST_WEIGHT,
+	PARAMETER_MUTATION_SHIELD_WEIGHT,
+	PARAMETER_MUTATION_BOOST_WEIGHT,
+	PARAMETER_FIRST_TURN_BOOST_DISTANCE,
+	PARAMETER_COUNT
 };
 
-class Solution
+const ParameterDefinition PARAMETER_DEFINITIONS[PARAMETER_COUNT] =
 {
-private:
-	vector<Turn> m_turns = vector<Turn>(SIMULATION_TURNS);
-public:
-	Turn& operator[](size_t t) { return m_turns[t]; }
-	const Turn& operator[](size_t t) const { return m_turns[t]; }
-
-	int score = -1;
+	{ "AHEAD_BIAS", AHEAD_BIAS, 0.25f, 8.0f, false },
+	{ "MUTATION_ROTATION_WEIGHT", MUTATION_ROTATION_WEIGHT, 1.0f, 20.0f, true },
+	{ "MUTATION_THRUST_WEIGHT", MUTATION_THRUST_WEIGHT, 0.0f, 20.0f, true },
+	{ "MUTATION_SHIELD_WEIGHT", MUTATION_SHIELD_WEIGHT, 0.0f, 20.0f, true },
+	{ "MUTATION_BOOST_WEIGHT", MUTATION_BOOST_WEIGHT, 0.0f, 20.0f, true },
+	{ "FIRST_TURN_BOOST_DISTANCE", FIRST_TURN_BOOST_DISTANCE, 0.0f, 16000.0f, false },
 };
-#pragma endregion BaseSimulationData
 
-#pragma region SimulationClass
-class Simulation
+class Parameters
 {
 private:
-	vector<Vector2> m_checkpoints;
-	int m_checkpointCount; //checkpoints in one lap
-	int m_maxCheckpoints; //total of checkpoints in all of the laps
-public:
-	int GetMaxCheckpoints() const { return m_maxCheckpoints; }
-	const vector<Vector2>& GetCheckpoints() const { return m_checkpoints; }
-	Vector2 InitCheckpoints();
-	void ComputeSolution(vector<Pod>& pods, const Solution& _solution) const;
-private:
-	void ComputeRotation(vector<Pod>& pods, const Turn& turn) const;
-	void computeSpeed(vector<Pod>& pods, const Turn& turn) const;
-	void ApplyRotationAndThrust(vector<Pod>& pods) const;
-	void ApplyFriction(vector<Pod>& pods) const;
-	void FinishTurn(vector<Pod>& pods) const;
-	void ComputeWholeTurn(vector<Pod>& pods, const Turn& turn) const;
-};
+	float m_values[PARAMETER_COUNT];
 
-Vector2 Simulation::InitCheckpoints()
-{
-	int laps;
-	cin >> laps;
-	cin.ignore();
-	cin >> m_checkpointCount;
-	cin.ignore();
-	m_checkpoints.reserve(m_checkpointCount);
-	for (int i = 0; i < m_checkpointCount; i++)
+	Parameters()
 	{
-		int x, y;
-		cin >> x >> y;
-		cin.ignore();
-		m_checkpoints[i] = Vector2((float)x, (float)y);
+		for (int i = 0; i < PARAMETER_COUNT; i++)
+		{
+			m_values[i] = PARAMETER_DEFINITIONS[i].value;
+		}
 	}
-	m_maxCheckpoints = m_checkpointCount * laps;
-	//return the first checkpoint that the pods will have to reach
-	return m_checkpoints[1];
-}
+public:
+	static Parameters& Get()
+	{
+		static Parameters parameters;
+		return parameters;
+	}
+	float operator[](ParameterId _id) const { return m_values[_id]; }
+	bool Set(const char* _name, float _value);
+	bool Load(const char* _path);
+	bool ParseArgument(int _argc, char** _argv, int& _a, bool& _isListRequested);
+	void Print() const;
+};
 
-void Simulation::ComputeSolution(vector<Pod>& _pods, const Solution& _solution) const
+//the value is clamped to the range of the parameter
+bool Parameters::Set(const char* _name, float _value)
 {
-	for (int i = 0; i < SIMULATION_TURNS; i++)
+	for (int i = 0; i < PARAMETER_COUNT; i++)
 	{
-		ComputeWholeTurn(_pods, _solution[i]);
+		const ParameterDefinition& definition = PARAMETER_DEFINITIONS[i];
+		if (strcmp(definition.name, _name) == 0)
+		{
+			const float value = clip(_value, definition.minimum, definition.maximum);
+			m_values[i] = definition.isInteger ? roundf(value) : value;
+			return true;
+		}
 	}
+	LOG_ERROR("unknown_parameter", "name", _name);
+	return false;
 }
-//expert rule number 1
-void Simulation::ComputeRotation(vector<Pod>& _pods, const Turn& _turn) const
+
+//empty lines and lines starting with # are skipped
+bool Parameters::Load(const char* _path)
 {
-	for (int i = 0; i < 2; i++)
+	FILE* file = fopen(_path, "r");
+	if (file == nullptr)
 	{
-		Pod& pod = _pods[i];
-		const Move& move = _turn[i];
-
-		pod.angle = (pod.angle + move.rotation) % 360;
+		LOG_ERROR("parameters_not_found", "path", _path);
+		return false;
 	}
-}
-//expert rule number 2
-void Simulation::computeSpeed(vector<Pod>& _pods, const Turn& _turn) const
-{
-	for (int i = 0; i < 2; i++)
+	bool isValid = true;
+	char line[256];
+	while (isValid && fgets(line, sizeof(line), file) != nullptr)
 	{
-		Pod& pod = _pods[i];
-		const Move& move = _turn[i];
-
-		ManageShield(move.useShield, pod);
-		if (pod.shieldCooldown > 0)
+		char name[128];
+		float value;
+		if (line[0] == '#' || sscanf(line, "%127s", name) != 1)
 		{
 			continue;
 		}
-
-		float angleRad = DEG2RAD(pod.angle);
-		Vector2 direction(cos(angleRad), sin(angleRad));
-
-		bool useBoost = false;
-		if (!pod.hasBoosted && move.useBoost)
-		{
-			useBoost = true;
-		}
-		int thrust;
-		if (useBoost)
-		{
-			thrust = THRUST_BOOST;
-			pod.hasBoosted = true;
-		}
-		else
-		{
-			thrust = move.thrust;
-		}
-		pod.speed += (float)thrust * direction;
+		isValid = sscanf(line, "%127s %f", name, &value) == 2 && Set(name, value);
 	}
+	fclose(file);
+	return isValid;
 }
-//expert rule number 3
-void Simulation::ApplyRotationAndThrust(vector<Pod>& _pods) const
+
+//parses the argument _argv[_a] and moves _a to its last value. False if it is not a parameter argument or if its value is invalid
+bool Parameters::ParseArgument(int _argc, char** _argv, int& _a, bool& _isListRequested)
 {
-	float time = 0.0f;
-	float endTime = 1.0f;
-	while (time < endTime)
+	const char* argument = _argv[_a];
+	if (strcmp(argument, "--parameters") == 0 && _a + 1 < _argc)
 	{
-		//Check for collisions
-		Pod* podA = nullptr;
-		Pod* podB = nullptr;
-		float dt = endTime - time;
-		for (int i = 0; i < 4; i++)
-		{
-			for (int j = i + 1; j < 4; j++)
-			{
-				float collisionTime = TimeToCollision(_pods[i], _pods[j]);
-				if ((time + collisionTime < endTime) && (collisionTime < dt))
-				{
-					dt = collisionTime;
-					podA = &_pods[i];
-					podB = &_pods[j];
-				}
-			}
-		}
-		//check collisions with checkpoints
-		for (Pod& pod : _pods)
-		{
-			pod.position += dt * pod.speed;
-
-			if (pow(Vector2::Distance(pod.position, m_checkpoints[pod.nextCheckpointId]), 2) < pow(CHECKPOINT_RADIUS, 2))
-			{
-				pod.nextCheckpointId = (pod.nextCheckpointId + 1) % m_checkpointCount;
-				pod.totalCheckpointsPassed++;
-			}
-		}
-		if (podA != nullptr && podB != nullptr)
-		{
-			Rebounce(*podA, *podB);
-		}
-		time += dt;
+		return Load(_argv[++_a]);
 	}
-}
-//expert rule number 4
-void Simulation::ApplyFriction(vector<Pod>& _pods) const
-{
-	for (Pod& pod : _pods)
+	if (strcmp(argument, "--set") == 0 && _a + 1 < _argc)
+	{
+		char name[128];
+		float value;
+		return sscanf(_argv[++_a], "%127[^=]=%f", name, &value) == 2 && Set(name, value);
+	}
+	if (strcmp(argument, "--list-parameters") == 0)
 	{
-		pod.speed *= FRICTION_FACTOR;
+		_isListRequested = true;
+		return true;
 	}
+	return false;
 }
-//expert rule number 5
-void Simulation::FinishTurn(vector<Pod>& _pods) const
+
+void Parameters::Print() const
 {
-	for (Pod& pod : _pods)
+	for (int i = 0; i < PARAMETER_COUNT; i++)
 	{
-		pod.speed = Vector2{ round(pod.speed.m_x), round(pod.speed.m_y) };
-		pod.position = Vector2{ round(pod.position.GetX()), round(pod.position.GetY()) };
+		const ParameterDefinition& definition = PARAMETER_DEFINITIONS[i];
+		printf("parameter name=%s value=%g minimum=%g maximum=%g integer=%d\n",
+			definition.name, m_values[i], definition.minimum, definition.maximum, definition.isInteger ? 1 : 0);
 	}
 }
+#pragma endregion Parameters
 
-void Simulation::ComputeWholeTurn(vector<Pod>& _pods, const Turn& _turn) const
+#pragma region InputOutput
+inline long ReadDescriptor(int _fd, char* _buffer, int _size)
 {
-	//Application of the "expert rules"
-	ComputeRotation(_pods, _turn);
-	computeSpeed(_pods, _turn);
-	ApplyRotationAndThrust(_pods);
-	ApplyFriction(_pods);
-	FinishTurn(_pods);
+#ifdef _MSC_VER
+	return _read(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)read(_fd, _buffer, (size_t)_size);
+#endif
 }
-#pragma endregion SimulationClass
 
-void OutputSolution(const Solution& _solution, vector<Pod>& _pods)
+inline long WriteDescriptor(int _fd, const char* _buffer, int _size)
 {
-	constexpr int turn = 0;
-	for (int i = 0; i < 2; i++)
-	{
-		Pod& pod = _pods[i];
-		const Move& move = _solution[turn][i];
+#ifdef _MSC_VER
+	return _write(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)write(_fd, _buffer, (size_t)_size);
+#endif
+}
 
-		float angle = (pod.angle + (float)move.rotation) % 360;
-		float angleRad = DEG2RAD(angle);
+//one line of the turn input
+struct PodInput
+{
+	int x, y, speedX, speedY, angle, nextCheckpointId;
+};
 
-		constexpr float targetDistance = 10000.0f;
-		Vector2 direction{ targetDistance * cos(angleRad), targetDistance * sin(angleRad) };
-		Vector2 target = pod.position + direction;
+struct TurnInput
+{
+	PodInput pods[POD_COUNT];
+};
+
+//Reads the referee input in large blocks and parses the integers in place, with no locale and no stdio synchronization.
+//The input of a whole turn usually arrives with a single read
+class InputReader
+{
+private:
+	static constexpr int BUFFER_SIZE = 1 << 16;
+	int m_fd;
+	vector<char> m_buffer;
+	const char* m_current = nullptr;
+	const char* m_end = nullptr;
+
+	bool Refill();
+public:
+	InputReader(int _fd = 0) : m_fd(_fd), m_buffer(BUFFER_SIZE) {}
+	//false at the end of the input
+	bool ReadInt(int& _value);
+	bool ReadTurn(TurnInput& _turn);
+	//blocks until the first number of the next input has arrived, false at the end of the input
+	bool WaitForInput();
+};
+
+bool InputReader::Refill()
+{
+	long size;
+	do
+	{
+		size = ReadDescriptor(m_fd, m_buffer.data(), BUFFER_SIZE);
+	} while (size < 0 && errno == EINTR);
+	if (size <= 0)
+	{
+		return false;
+	}
+	m_current = m_buffer.data();
+	m_end = m_current + size;
+	return true;
+}
 
-		cout << round(target.GetX()) << " " << round(target.GetY()) << " ";
-		if (move.useShield)
+bool InputReader::ReadInt(int& _value)
+{
+	//skip the separators
+	while (true)
+	{
+		if (m_current == m_end && !Refill())
 		{
-			cout << "SHIELD" << " SHIELD";
+			return false;
 		}
-		else if (move.useBoost)
+		if (*m_current == '-' || (unsigned int)(*m_current - '0') < 10u)
 		{
-			cout << "BOOST" << " BOOST";
+			break;
 		}
-		else
+		m_current++;
+	}
+	const bool isNegative = *m_current == '-';
+	m_current += isNegative;
+	//a number can be cut by the end of the buffer
+	int value = 0;
+	do
+	{
+		while (m_current < m_end && (unsigned int)(*m_current - '0') < 10u)
 		{
-			cout << move.thrust << " " << move.thrust;
+			value = value * 10 + (*m_current++ - '0');
 		}
-		cout << endl;
-	}
+	} while (m_current == m_end && Refill());
+	_value = isNegative ? -value : value;
+	return true;
 }
 
-void UpdateShieldAndBoostForNextTurn(const Solution& _solution, vector<Pod>& _pods)
+bool InputReader::WaitForInput()
 {
-	for (int i = 0; i < 2; i++)
+	//the end of line of the previous input can still be in the buffer
+	while (true)
 	{
-		Pod& pod = _pods[i];
-		const Move& move = _solution[0][i];
-
-		ManageShield(move.useShield, pod);
-		if (pod.shieldCooldown == 0 && move.useBoost)
+		if (m_current == m_end && !Refill())
 		{
-			pod.hasBoosted = true;
+			return false;
+		}
+		if (*m_current == '-' || (unsigned int)(*m_current - '0') < 10u)
+		{
+			return true;
 		}
+		m_current++;
 	}
 }
 
-//Much faster function than std::rand to generate a random number
-int fastrand()
-{
-	static unsigned int g_seed = 100;
-	g_seed = (214013 * g_seed + 2531011);
-	return (g_seed >> 16) & 0x7FFF;
-}
-inline int rnd(int a, int b)
+bool InputReader::ReadTurn(TurnInput& _turn)
 {
-	return (fastrand() % (b - a)) + a;
+	for (PodInput& pod : _turn.pods)
+	{
+		if (!(ReadInt(pod.x) && ReadInt(pod.y) && ReadInt(pod.speedX) && ReadInt(pod.speedY) && ReadInt(pod.angle) && ReadInt(pod.nextCheckpointId)))
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
-#pragma region SolverClass
-class Solver
+//The output of a turn is formatted in one buffer and sent with a single write on Flush
+class OutputWriter
 {
 private:
-	vector<Solution> m_solutions;
-	Simulation* m_simulation;
-
+	int m_fd;
+	string m_buffer;
 public:
-	Solver(Simulation* _simulation);
-	const Solution& Solve(const vector<Pod>& _pods, int _time);
-
-private:
-	void InitPopulation();
-	void FirstTurnBoost();
-	void Randomize(Move& _move, bool _modifyAll = true) const;
-	void ShiftByOneTurn(Solution& _solution) const;
-	void Mutate(Solution& _solution) const;
-	int ComputeScore(Solution& _solution, const vector<Pod>& _pods) const;
-	int RateSolution(vector<Pod>& _pods) const;
+	OutputWriter(int _fd = 1) : m_fd(_fd) { m_buffer.reserve(256); }
+	void Write(const char* _text) { m_buffer += _text; }
+	void Write(char _c) { m_buffer += _c; }
+	void Write(int _value);
+	void Flush();
 };
 
-Solver::Solver(Simulation* _simulation)
-{
-	m_simulation = _simulation;
-	InitPopulation();
-	FirstTurnBoost();
-}
-
-const Solution& Solver::Solve(const vector<Pod>& _pods, int _time)
+void OutputWriter::Write(int _value)
 {
-	//check if we can keep iterating without spending too much time
-	using namespace std::chrono;
-	auto start = high_resolution_clock::now();
-	//check if I have enough time to run another round of solutions
-	auto keepSolving = [&start, _time]() -> bool
+	char digits[12];
+	int count = 0;
+	unsigned int magnitude = _value < 0 ? 0u - (unsigned int)_value : (unsigned int)_value;
+	do
 	{
-		auto now = high_resolution_clock::now();
-		auto d = duration_cast<milliseconds>(now - start);
-		return (d.count() < _time);
-	};
-	//init this turn
-	for (int i = 0; i < SOLUTIONS_COUNT; i++)
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (_value < 0)
 	{
-		Solution& s = m_solutions[i];
-		ShiftByOneTurn(s);
-		ComputeScore(s, _pods);
+		m_buffer += '-';
 	}
-
-	while (keepSolving())
+	while (count > 0)
 	{
-
-		//build and rate mutated versions of our solutions
-		for (int i = 0; i < SOLUTIONS_COUNT; ++i)
-		{
-			Solution& newSolution = m_solutions[SOLUTIONS_COUNT + i];
-			newSolution = m_solutions[i];
-			Mutate(newSolution);
-			ComputeScore(newSolution, _pods);
-		}
-		//sort the solutions by score
-		std::sort(m_solutions.begin(), m_solutions.end(), [](const Solution& a, const Solution& b)
-			{return a.score > b.score; });
+		m_buffer += digits[--count];
 	}
-	return m_solutions[0];
 }
 
-void Solver::InitPopulation()
+void OutputWriter::Flush()
 {
-	// 0 to (SOLUTIONS_COUNT - 1) are actual solutions from the previous turn
-	// SOLUTIONS_COUNT to (2 * SOLUTIONS_COUNT - 1): temporary solutions from Solve()
-	m_solutions.resize(2 * SOLUTIONS_COUNT);
-
-	//randomize starting solutions
-	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	int written = 0;
+	while (written < (int)m_buffer.size())
 	{
-		for (int t = 0; t < SIMULATION_TURNS; t++)
+		const long size = WriteDescriptor(m_fd, m_buffer.data() + written, (int)m_buffer.size() - written);
+		if (size < 0 && errno == EINTR)
 		{
-			for (int i = 0; i < 2; i++)
-			{
-				Randomize(m_solutions[s][t][i]);
-			}
+			continue;
 		}
-	}
+		if (size <= 0)
+		{
+			break;
+		}
+		written += size;
+	}
+	m_buffer.clear();
+}
+#pragma endregion InputOutput
+
+struct Pod
+{
+	Vector2 position;
+	Vector2 speed;
+	int angle = -1;
+
+	int nextCheckpointId = 0;
+	int totalCheckpointsPassed = 0;
+
+	bool hasBoosted = false;
+	int shieldCooldown = 0;
+
+	int score = 0;
+};
+
+void ManageShield(bool _isTurnedOn, Pod& _pod)
+{
+	if (_isTurnedOn)
+	{
+		_pod.shieldCooldown = SHIELD_COOLDOWN;
+	}
+	else if (_pod.shieldCooldown > 0)
+	{
+		_pod.shieldCooldown--;
+	}
+}
+
+void UpdatePodInfo(Pod& _pod, const PodInput& _input)
+{
+	_pod.position = Vector2((float)_input.x, (float)_input.y);
+	_pod.speed = Vector2((float)_input.speedX, (float)_input.speedY);
+	_pod.angle = _input.angle;
+	//check if the pod has passed a checkpoint since the last turn
+	if (_pod.nextCheckpointId != _input.nextCheckpointId)
+	{
+		_pod.totalCheckpointsPassed++;
+	}
+	_pod.nextCheckpointId = _input.nextCheckpointId;
+}
+
+#pragma region RaceStateStruct
+//Snapshot of the 4 pods used by the simulation.
+//Fixed size and stored as a structure of arrays so that a copy is a plain stack copy, with no heap allocation
+struct RaceState
+{
+	float x[POD_COUNT];
+	float y[POD_COUNT];
+	float speedX[POD_COUNT];
+	float speedY[POD_COUNT];
+	int angle[POD_COUNT];
+
+	int nextCheckpointId[POD_COUNT];
+	int totalCheckpointsPassed[POD_COUNT];
+
+	int shieldCooldown[POD_COUNT];
+	bool hasBoosted[POD_COUNT];
+
+	void Load(const vector<Pod>& _pods);
+	Vector2 GetPosition(int _i) const { return Vector2(x[_i], y[_i]); }
+	Vector2 GetSpeed(int _i) const { return Vector2(speedX[_i], speedY[_i]); }
+};
+
+void RaceState::Load(const vector<Pod>& _pods)
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		Pod pod = _pods[i];
+		x[i] = pod.position.GetX();
+		y[i] = pod.position.GetY();
+		speedX[i] = pod.speed.GetX();
+		speedY[i] = pod.speed.GetY();
+		angle[i] = pod.angle;
+		nextCheckpointId[i] = pod.nextCheckpointId;
+		totalCheckpointsPassed[i] = pod.totalCheckpointsPassed;
+		shieldCooldown[i] = pod.shieldCooldown;
+		hasBoosted[i] = pod.hasBoosted;
+	}
+}
+
+void ManageShield(bool _isTurnedOn, RaceState& _state, int _i)
+{
+	if (_isTurnedOn)
+	{
+		_state.shieldCooldown[_i] = SHIELD_COOLDOWN;
+	}
+	else if (_state.shieldCooldown[_i] > 0)
+	{
+		_state.shieldCooldown[_i]--;
+	}
+}
+#pragma endregion RaceStateStruct
+
+#pragma region BatchStateStruct
+//RaceState of BATCH_LANES candidates advanced in lockstep: lane l of every array belongs to candidate l
+struct BatchState
+{
+	alignas(64) float x[POD_COUNT][BATCH_LANES];
+	alignas(64) float y[POD_COUNT][BATCH_LANES];
+	alignas(64) float speedX[POD_COUNT][BATCH_LANES];
+	alignas(64) float speedY[POD_COUNT][BATCH_LANES];
+	alignas(64) int angle[POD_COUNT][BATCH_LANES];
+
+	alignas(64) int nextCheckpointId[POD_COUNT][BATCH_LANES];
+	alignas(64) int totalCheckpointsPassed[POD_COUNT][BATCH_LANES];
+
+	alignas(64) int shieldCooldown[POD_COUNT][BATCH_LANES];
+	alignas(64) int hasBoosted[POD_COUNT][BATCH_LANES];
+
+	void Extract(int _lane, RaceState& _state) const;
+	void Insert(int _lane, const RaceState& _state);
+};
+
+void BatchState::Extract(int _lane, RaceState& _state) const
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		_state.x[i] = x[i][_lane];
+		_state.y[i] = y[i][_lane];
+		_state.speedX[i] = speedX[i][_lane];
+		_state.speedY[i] = speedY[i][_lane];
+		_state.angle[i] = angle[i][_lane];
+		_state.nextCheckpointId[i] = nextCheckpointId[i][_lane];
+		_state.totalCheckpointsPassed[i] = totalCheckpointsPassed[i][_lane];
+		_state.shieldCooldown[i] = shieldCooldown[i][_lane];
+		_state.hasBoosted[i] = hasBoosted[i][_lane] != 0;
+	}
+}
+
+void BatchState::Insert(int _lane, const RaceState& _state)
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		x[i][_lane] = _state.x[i];
+		y[i][_lane] = _state.y[i];
+		speedX[i][_lane] = _state.speedX[i];
+		speedY[i][_lane] = _state.speedY[i];
+		angle[i][_lane] = _state.angle[i];
+		nextCheckpointId[i][_lane] = _state.nextCheckpointId[i];
+		totalCheckpointsPassed[i][_lane] = _state.totalCheckpointsPassed[i];
+		shieldCooldown[i][_lane] = _state.shieldCooldown[i];
+		hasBoosted[i][_lane] = _state.hasBoosted[i];
+	}
+}
+#pragma endregion BatchStateStruct
+
+#pragma region PhysicsFunctions
+float GetPodMass(const RaceState& _state, int _i)
+{
+	float mass = 1.0f;
+	//check if shield is active
+	if (_state.shieldCooldown[_i] == SHIELD_COOLDOWN)
+	{
+		mass = 10.0f;
+	}
+	return mass;
+}
+
+float TimeToCollision(const RaceState& _state, int _a, int _b)
+{
+	//physics simulation to check if a collision is imminent
+	const float positionDifferenceX = _state.x[_b] - _state.x[_a];
+	const float positionDifferenceY = _state.y[_b] - _state.y[_a];
+	const float speedDifferenceX = _state.speedX[_b] - _state.speedX[_a];
+	const float speedDifferenceY = _state.speedY[_b] - _state.speedY[_a];
+
+	float a = speedDifferenceX * speedDifferenceX + speedDifferenceY * speedDifferenceY;
+	if (a < EPSILON)
+	{
+		return INFINITY;
+	}
+
+	float b = -2.0f * (positionDifferenceX * speedDifferenceX + positionDifferenceY * speedDifferenceY);
+	float c = positionDifferenceX * positionDifferenceX + positionDifferenceY * positionDifferenceY - 4.0f * POD_RADIUS * POD_RADIUS;
+
+	float delta = b * b - 4.f * a * c;
+	if (delta < 0.0f)
+	{
+		return INFINITY;
+	}
+
+	float time = (b - sqrt(delta)) / (2.f * a);
+	if (time <= EPSILON)
+	{
+		return INFINITY;
+	}
+	return time;
+}
+
+//Broad phase: 2 pods can only touch before _endTime if, on both axes, their distance is below 2 * POD_RADIUS plus the distance they travel relative to each other.
+//No sqrt and no square, the small margin makes sure it never rejects a pair that TimeToCollision would accept
+bool CanCollide(const RaceState& _state, int _a, int _b, float _time, float _endTime)
+{
+	constexpr float margin = 2.0f * POD_RADIUS + 1.0f;
+	const float remainingTime = _endTime - _time;
+	const float gapX = fabsf(_state.x[_b] - _state.x[_a]) - fabsf(_state.speedX[_b] - _state.speedX[_a]) * remainingTime;
+	const float gapY = fabsf(_state.y[_b] - _state.y[_a]) - fabsf(_state.speedY[_b] - _state.speedY[_a]) * remainingTime;
+	return gapX <= margin && gapY <= margin;
+}
+
+//absolute time of the next collision between 2 pods, INFINITY if they do not collide before _endTime
+float NextCollisionTime(const RaceState& _state, int _a, int _b, float _time, float _endTime)
+{
+	if (!CanCollide(_state, _a, _b, _time, _endTime))
+	{
+		return INFINITY;
+	}
+	const float collisionTime = _time + TimeToCollision(_state, _a, _b);
+	return collisionTime < _endTime ? collisionTime : INFINITY;
+}
+
+void Rebounce(RaceState& _state, int _a, int _b)
+{
+	//calculate how the pods will rebounce after a collision
+	float massA = GetPodMass(_state, _a);
+	float massB = GetPodMass(_state, _b);
+
+	const float positionDifferenceX = _state.x[_b] - _state.x[_a];
+	const float positionDifferenceY = _state.y[_b] - _state.y[_a];
+	float distance = sqrt(positionDifferenceX * positionDifferenceX + positionDifferenceY * positionDifferenceY);
+
+	const float dirX = positionDifferenceX / distance;
+	const float dirY = positionDifferenceY / distance;
+	const float speedDifferenceX = _state.speedX[_b] - _state.speedX[_a];
+	const float speedDifferenceY = _state.speedY[_b] - _state.speedY[_a];
+
+	float mass = (massA * massB) / (massA + massB);
+	float dirDotSpeedDiff = speedDifferenceX * dirX + speedDifferenceY * dirY;
+
+	float impulse = -2.0f * mass * dirDotSpeedDiff;
+	impulse = clip(impulse, -REBOUNCE_MINIMUM_IMPULSE, REBOUNCE_MINIMUM_IMPULSE);
+
+	_state.speedX[_a] -= massA * impulse * dirX;
+	_state.speedY[_a] -= massA * impulse * dirY;
+	_state.speedX[_b] += massB * impulse * dirX;
+	_state.speedY[_b] += massB * impulse * dirY;
+}
+#pragma endregion PhysicsFunctions
+
+#pragma region BaseSimulationData
+//A move packed into 16 bits:
+//bits 0-5: rotation + ROTATION_MAXIMUM, bits 6-12: thrust, bit 13: boost, bit 14: shield
+class Move
+{
+public:
+	static constexpr uint16_t ROTATION_MASK = 0x3F;
+	static constexpr int THRUST_SHIFT = 6;
+	static constexpr uint16_t THRUST_MASK = 0x7F << THRUST_SHIFT;
+	static constexpr uint16_t BOOST_BIT = 1 << 13;
+	static constexpr uint16_t SHIELD_BIT = 1 << 14;
+private:
+	uint16_t m_bits = ROTATION_MAXIMUM; //rotation 0, thrust 0, no boost, no shield
+public:
+	inline uint16_t GetBits() const { return m_bits; }
+
+	inline int GetRotation() const { return (int)(m_bits & ROTATION_MASK) - ROTATION_MAXIMUM; } // between -ROTATION_MAXIMUM and ROTATION_MAXIMUM
+	inline int GetThrust() const { return (m_bits & THRUST_MASK) >> THRUST_SHIFT; } //between 0 and THRUST_MAXIMUM
+	inline bool GetUseBoost() const { return (m_bits & BOOST_BIT) != 0; }
+	inline bool GetUseShield() const { return (m_bits & SHIELD_BIT) != 0; }
+
+	inline void SetRotation(int _rotation) { m_bits = (uint16_t)((m_bits & ~ROTATION_MASK) | (_rotation + ROTATION_MAXIMUM)); }
+	inline void SetThrust(int _thrust) { m_bits = (uint16_t)((m_bits & ~THRUST_MASK) | (_thrust << THRUST_SHIFT)); }
+	inline void SetUseBoost(bool _useBoost) { m_bits = _useBoost ? (m_bits | BOOST_BIT) : (m_bits & ~BOOST_BIT); }
+	inline void SetUseShield(bool _useShield) { m_bits = _useShield ? (m_bits | SHIELD_BIT) : (m_bits & ~SHIELD_BIT); }
+};
+
+class Turn
+{
+private:
+	Move m_moves[2];
+public:
+	Move& operator[](size_t m) { return m_moves[m]; }
+	const Move& operator[](size_t m) const { return m_moves[m]; }
+};
+
+//flat genome: copying a solution is a single memcpy
+class Solution
+{
+private:
+	Turn m_turns[SIMULATION_TURNS];
+public:
+	Turn& operator[](size_t t) { return m_turns[t]; }
+	const Turn& operator[](size_t t) const { return m_turns[t]; }
+
+	int score = -1;
+
+	//state of the race after each simulated turn, only turns before firstDirtyTurn are up to date.
+	//A mutant copies the cache of its parent and only simulates the turns after its mutation.
+	//The cache is most of the size of a solution: the engines that rank their solutions sort their indices and leave them in place
+	RaceState states[SIMULATION_TURNS];
+	int firstDirtyTurn = 0;
+
+	void Invalidate(int _turn) { firstDirtyTurn = min(firstDirtyTurn, _turn); }
+	const RaceState& GetFinalState() const { return states[SIMULATION_TURNS - 1]; }
+};
+static_assert(is_trivially_copyable<Solution>::value, "Solution must stay trivially copyable");
+
+//Coarse move set of the tree searches: every rotation of DISCRETE_ROTATIONS with every thrust of DISCRETE_THRUSTS, then the shield.
+//The boost keeps a thrust of THRUST_MAXIMUM for the pods that have already used theirs
+#define DISCRETE_ROTATION_COUNT 5
+#define DISCRETE_THRUST_COUNT 4
+#define DISCRETE_MOVE_COUNT (DISCRETE_ROTATION_COUNT * DISCRETE_THRUST_COUNT + 1)
+constexpr int DISCRETE_ROTATIONS[DISCRETE_ROTATION_COUNT] = { -ROTATION_MAXIMUM, -ROTATION_MAXIMUM / 2, 0, ROTATION_MAXIMUM / 2, ROTATION_MAXIMUM };
+constexpr int DISCRETE_THRUSTS[DISCRETE_THRUST_COUNT] = { 0, THRUST_MAXIMUM / 2, THRUST_MAXIMUM, THRUST_BOOST };
+
+inline Move GetDiscreteMove(int _index)
+{
+	Move move;
+	if (_index == DISCRETE_MOVE_COUNT - 1)
+	{
+		move.SetUseShield(true);
+		return move;
+	}
+	const int thrust = DISCRETE_THRUSTS[_index % DISCRETE_THRUST_COUNT];
+	move.SetRotation(DISCRETE_ROTATIONS[_index / DISCRETE_THRUST_COUNT]);
+	move.SetThrust(min(thrust, THRUST_MAXIMUM));
+	move.SetUseBoost(thrust == THRUST_BOOST);
+	return move;
+}
+#pragma endregion BaseSimulationData
+
+#pragma region TrackModelStruct
+//Geometry of the race computed once at the first turn. Checkpoint c is reached by the segment from checkpoint c - 1
+struct TrackModel
+{
+	vector<Vector2> checkpoints;
+	vector<float> segmentLengths; //length of the segment that ends at each checkpoint
+	vector<float> raceDistances; //distance from the start when the pod has passed k checkpoints, the start line counts as the first one
+
+	void Build(const vector<Vector2>& _checkpoints, int _laps);
+	float GetRaceProgress(const RaceState& _state, int _i) const;
+};
+
+void TrackModel::Build(const vector<Vector2>& _checkpoints, int _laps)
+{
+	const int checkpointCount = (int)_checkpoints.size();
+	checkpoints = _checkpoints;
+	segmentLengths.resize(checkpointCount);
+	for (int c = 0; c < checkpointCount; c++)
+	{
+		Vector2 checkpoint = _checkpoints[c];
+		const Vector2& previousCheckpoint = _checkpoints[(c + checkpointCount - 1) % checkpointCount];
+		segmentLengths[c] = Vector2::Distance(previousCheckpoint, checkpoint);
+	}
+	//one entry per checkpoint of the race, plus the checkpoint before the start and the one after the finish line
+	const int raceCheckpoints = checkpointCount * _laps + 2;
+	raceDistances.resize(raceCheckpoints + 1);
+	raceDistances[0] = -segmentLengths[0];
+	raceDistances[1] = 0.0f;
+	for (int k = 2; k <= raceCheckpoints; k++)
+	{
+		raceDistances[k] = raceDistances[k - 1] + segmentLengths[(k - 1) % checkpointCount];
+	}
+}
+
+//distance raced by pod _i along the track: distance of its next checkpoint minus the distance left to reach it.
+//The straight distance is used and not the projection on the segment: with the projection a pod passing beside the checkpoint keeps scoring
+inline float TrackModel::GetRaceProgress(const RaceState& _state, int _i) const
+{
+	const int target = min(_state.totalCheckpointsPassed[_i] + 1, (int)raceDistances.size() - 1);
+	const Vector2& checkpoint = checkpoints[_state.nextCheckpointId[_i]];
+	const float toCheckpointX = checkpoint.GetX() - _state.x[_i];
+	const float toCheckpointY = checkpoint.GetY() - _state.y[_i];
+	return raceDistances[target] - sqrt(toCheckpointX * toCheckpointX + toCheckpointY * toCheckpointY);
+}
+#pragma endregion TrackModelStruct
+
+#pragma region OpponentModelClass
+//Policy of the opponent pods inside the simulation, in place of coasting. Like Pod::UpdateSteering of the older bots, a pod steers to its next checkpoint
+//with its drift compensated: it aims OPPONENT_DRIFT_COMPENSATION turns of its speed short of the checkpoint.
+//Its thrust, the distance from which it boosts and the distance from which it shields are fitted online on the opponents seen during the game.
+//A move costs one table lookup, a few products and at most one sqrt
+class OpponentModel
+{
+private:
+	float m_alignedThrust[2] = { (float)THRUST_MAXIMUM, (float)THRUST_MAXIMUM }; //thrust when the pod can face its target this turn
+	float m_turningThrust[2] = { (float)THRUST_MAXIMUM, (float)THRUST_MAXIMUM }; //thrust while it turns towards it
+	//shared by the two pods, they run the same bot
+	float m_boostDistanceSquared = OPPONENT_BOOST_DISTANCE * OPPONENT_BOOST_DISTANCE;
+	float m_shieldDistanceSquared = 0.0f; //no shield until one is seen
+	float m_contactDistanceSquared[2] = { -1.0f, -1.0f }; //distance to our closest pod before a collision on the last turn, -1 without one
+
+public:
+	Move GetMove(int _i, float _x, float _y, float _speedX, float _speedY, int _angle, const Vector2& _checkpoint, bool _hasBoosted,
+		float _ourDistanceSquared) const;
+	Move GetMove(const RaceState& _state, int _i, const vector<Vector2>& _checkpoints) const;
+	void Observe(const RaceState& _previous, vector<Pod>& _pods, const vector<Vector2>& _checkpoints);
+	static float GetOurDistanceSquared(const RaceState& _state, int _i);
+
+private:
+	static int Steer(float _x, float _y, float _speedX, float _speedY, int _angle, const Vector2& _checkpoint, float& _distanceSquared, bool& _isAligned);
+};
+
+//rotation towards the target, _isAligned when the pod faces it after the rotation
+inline int OpponentModel::Steer(float _x, float _y, float _speedX, float _speedY, int _angle, const Vector2& _checkpoint, float& _distanceSquared, bool& _isAligned)
+{
+	//sin(ROTATION_MAXIMUM) squared: the target is within reach of one rotation
+	constexpr float reachSquared = 0.0954915f;
+	const float toTargetX = _checkpoint.GetX() - OPPONENT_DRIFT_COMPENSATION * _speedX - _x;
+	const float toTargetY = _checkpoint.GetY() - OPPONENT_DRIFT_COMPENSATION * _speedY - _y;
+	const Vector2& facing = Vector2::FromAngle(_angle);
+	const float dot = facing.GetX() * toTargetX + facing.GetY() * toTargetY;
+	const float cross = facing.GetX() * toTargetY - facing.GetY() * toTargetX;
+	_distanceSquared = toTargetX * toTargetX + toTargetY * toTargetY;
+	_isAligned = dot > 0.0f && cross * cross < reachSquared * _distanceSquared;
+	if (!_isAligned)
+	{
+		return cross >= 0.0f ? ROTATION_MAXIMUM : -ROTATION_MAXIMUM;
+	}
+	//sin(x) is close enough to x below ROTATION_MAXIMUM, rounded without the call to round()
+	const float degrees = RAD2DEG(cross / sqrt(max(_distanceSquared, EPSILON)));
+	return (int)(degrees < 0.0f ? degrees - 0.5f : degrees + 0.5f);
+}
+
+//_i is the pod, 2 or 3. _ourDistanceSquared is the squared distance to our closest pod
+inline Move OpponentModel::GetMove(int _i, float _x, float _y, float _speedX, float _speedY, int _angle, const Vector2& _checkpoint, bool _hasBoosted,
+	float _ourDistanceSquared) const
+{
+	Move move;
+	if (_ourDistanceSquared < m_shieldDistanceSquared)
+	{
+		move.SetUseShield(true);
+		return move;
+	}
+	float distanceSquared;
+	bool isAligned;
+	move.SetRotation(Steer(_x, _y, _speedX, _speedY, _angle, _checkpoint, distanceSquared, isAligned));
+	move.SetThrust((int)((isAligned ? m_alignedThrust[_i - 2] : m_turningThrust[_i - 2]) + 0.5f));
+	move.SetUseBoost(isAligned && !_hasBoosted && distanceSquared > m_boostDistanceSquared);
+	return move;
+}
+
+inline float OpponentModel::GetOurDistanceSquared(const RaceState& _state, int _i)
+{
+	float distanceSquared = INFINITY;
+	for (int j = 0; j < 2; j++)
+	{
+		const float dx = _state.x[j] - _state.x[_i];
+		const float dy = _state.y[j] - _state.y[_i];
+		distanceSquared = min(distanceSquared, dx * dx + dy * dy);
+	}
+	return distanceSquared;
+}
+
+inline Move OpponentModel::GetMove(const RaceState& _state, int _i, const vector<Vector2>& _checkpoints) const
+{
+	//the distance to our pods is only needed once a shield has been seen
+	return GetMove(_i, _state.x[_i], _state.y[_i], _state.speedX[_i], _state.speedY[_i], _state.angle[_i], _checkpoints[_state.nextCheckpointId[_i]],
+		_state.hasBoosted[_i], m_shieldDistanceSquared > 0.0f ? GetOurDistanceSquared(_state, _i) : INFINITY);
+}
+
+//The thrust of the last turn is the part of the change of speed along the new facing of the pod, once the friction is removed.
+//A change across the facing means a collision, the turn is not used for the thrust.
+//A boost is a thrust above THRUST_MAXIMUM. A shield is a pod that does not thrust right after it collided with one of our pods,
+//it is seen one turn late. The boost and the shield of the opponents are written in _pods for the next simulations
+void OpponentModel::Observe(const RaceState& _previous, vector<Pod>& _pods, const vector<Vector2>& _checkpoints)
+{
+	for (int i = 2; i < POD_COUNT; i++)
+	{
+		Pod& pod = _pods[i];
+		const int k = i - 2;
+		const Vector2& facing = Vector2::FromAngle(pod.angle);
+		const float pushX = pod.speed.GetX() / FRICTION_FACTOR - _previous.speedX[i];
+		const float pushY = pod.speed.GetY() / FRICTION_FACTOR - _previous.speedY[i];
+		const float thrust = pushX * facing.GetX() + pushY * facing.GetY();
+		const float sideways = pushX * facing.GetY() - pushY * facing.GetX();
+		const float ourDistanceSquared = GetOurDistanceSquared(_previous, i);
+		ManageShield(false, pod);
+
+		const float contactDistanceSquared = m_contactDistanceSquared[k];
+		m_contactDistanceSquared[k] = -1.0f;
+		if (fabs(sideways) > OPPONENT_COLLISION_TOLERANCE)
+		{
+			m_contactDistanceSquared[k] = ourDistanceSquared < OPPONENT_CONTACT_DISTANCE * OPPONENT_CONTACT_DISTANCE ? ourDistanceSquared : -1.0f;
+			continue;
+		}
+		if (_previous.shieldCooldown[i] > 1)
+		{
+			continue;
+		}
+		if (thrust > (THRUST_MAXIMUM + THRUST_BOOST) / 2)
+		{
+			const Vector2& checkpoint = _checkpoints[_previous.nextCheckpointId[i]];
+			const float dx = checkpoint.GetX() - _previous.x[i];
+			const float dy = checkpoint.GetY() - _previous.y[i];
+			m_boostDistanceSquared += OPPONENT_FIT_SMOOTHING * (dx * dx + dy * dy - m_boostDistanceSquared);
+			pod.hasBoosted = true;
+		}
+		else if (thrust < 1.0f && contactDistanceSquared >= 0.0f)
+		{
+			m_shieldDistanceSquared = m_shieldDistanceSquared == 0.0f ? contactDistanceSquared
+				: m_shieldDistanceSquared + OPPONENT_FIT_SMOOTHING * (contactDistanceSquared - m_shieldDistanceSquared);
+			//the shield was raised a turn ago, the pod has already spent one of the turns without thrust
+			pod.shieldCooldown = SHIELD_COOLDOWN - 1;
+		}
+		else
+		{
+			//the steering of the policy tells if the pod could face its target
+			float distanceSquared;
+			bool isAligned;
+			Steer(_previous.x[i], _previous.y[i], _previous.speedX[i], _previous.speedY[i], _previous.angle[i], _checkpoints[_previous.nextCheckpointId[i]],
+				distanceSquared, isAligned);
+			float& fittedThrust = isAligned ? m_alignedThrust[k] : m_turningThrust[k];
+			fittedThrust += OPPONENT_FIT_SMOOTHING * (clamp(thrust, 0.0f, (float)THRUST_MAXIMUM) - fittedThrust);
+		}
+	}
+}
+#pragma endregion OpponentModelClass
+
+#pragma region SimulationClass
+class Simulation
+{
+	friend class Microbenchmark;
+private:
+	//the pairs of pods that can collide
+	static constexpr int PAIR_COUNT = POD_COUNT * (POD_COUNT - 1) / 2;
+	static constexpr int PAIR_A[PAIR_COUNT] = { 0, 0, 0, 1, 1, 2 };
+	static constexpr int PAIR_B[PAIR_COUNT] = { 1, 2, 3, 2, 3, 3 };
+
+	vector<Vector2> m_checkpoints;
+	int m_checkpointCount; //checkpoints in one lap
+	int m_maxCheckpoints; //total of checkpoints in all of the laps
+	TrackModel m_track;
+	OpponentModel m_opponentModel;
+public:
+	int GetMaxCheckpoints() const { return m_maxCheckpoints; }
+	const vector<Vector2>& GetCheckpoints() const { return m_checkpoints; }
+	const TrackModel& GetTrack() const { return m_track; }
+	Vector2 InitCheckpoints(InputReader& _input);
+	void SetCheckpoints(const vector<Vector2>& _checkpoints, int _laps);
+	//movement, collisions, checkpoints and friction of one turn, once the rotation and thrust are applied. Used by the referee
+	void MovePods(RaceState& _state) const;
+	void ComputeSolution(RaceState& _state, const Solution& _solution) const;
+	void ComputeSolutionSuffix(Solution& _solution, const RaceState& _state) const;
+	void ComputeSolutionBatch(BatchState& _batch, Solution* const* _solutions, int _laneCount, const RaceState& _state) const;
+	//turn with a move for every pod, for the searches that also plan the moves of the opponents
+	void ComputeWholeTurn(RaceState& _state, const Move (&_moves)[POD_COUNT]) const;
+	//fits the policy of the opponents on the turn that has just been played, not while a search runs
+	void ObserveOpponents(const RaceState& _previous, vector<Pod>& _pods) { m_opponentModel.Observe(_previous, _pods, m_checkpoints); }
+private:
+	void ComputeRotation(RaceState& _state, const Move* _moves, int _podCount) const;
+	void computeSpeed(RaceState& _state, const Move* _moves, int _podCount) const;
+	float NextCheckpointTime(const RaceState& _state, int _i, float _time, float _endTime) const;
+	void ApplyRotationAndThrust(RaceState& _state) const;
+	void ApplyFriction(RaceState& _state) const;
+	void FinishTurn(RaceState& _state) const;
+	void ComputeWholeTurn(RaceState& _state, const Turn& turn) const;
+	void ComputeWholeTurnBatch(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const;
+#if BATCH_SIMD
+	template<int WIDTH> FORCE_INLINE void NextCheckpointTimeLanes(const typename Lanes<WIDTH>::Float* _x, const typename Lanes<WIDTH>::Float* _y, const typename Lanes<WIDTH>::Float* _speedX,
+		const typename Lanes<WIDTH>::Float* _speedY, const typename Lanes<WIDTH>::Int& _checkpointId, int _i, const typename Lanes<WIDTH>::Float& _time, typename Lanes<WIDTH>::Float& _entryTime) const;
+	template<int WIDTH> FORCE_INLINE void ComputeWholeTurnLanes(BatchState& _batch, const Solution* const* _solutions, int _turn, int _firstLane) const;
+	__attribute__((target("avx512f"))) void ComputeWholeTurnAvx512(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const;
+	__attribute__((target("avx2"))) void ComputeWholeTurnAvx2(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const;
+	void ComputeWholeTurnSse2(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const;
+#endif
+};
+
+Vector2 Simulation::InitCheckpoints(InputReader& _input)
+{
+	int laps = 0;
+	int checkpointCount = 0;
+	_input.ReadInt(laps);
+	_input.ReadInt(checkpointCount);
+	vector<Vector2> checkpoints(checkpointCount);
+	for (int i = 0; i < checkpointCount; i++)
+	{
+		int x = 0, y = 0;
+		_input.ReadInt(x);
+		_input.ReadInt(y);
+		checkpoints[i] = Vector2((float)x, (float)y);
+	}
+	SetCheckpoints(checkpoints, laps);
+	//return the first checkpoint that the pods will have to reach
+	return m_checkpoints[1];
+}
+
+void Simulation::SetCheckpoints(const vector<Vector2>& _checkpoints, int _laps)
+{
+	m_checkpoints = _checkpoints;
+	m_checkpointCount = (int)_checkpoints.size();
+	m_maxCheckpoints = m_checkpointCount * _laps;
+	m_track.Build(m_checkpoints, _laps);
+}
+
+void Simulation::MovePods(RaceState& _state) const
+{
+	ApplyRotationAndThrust(_state);
+	ApplyFriction(_state);
+}
+
+void Simulation::ComputeSolution(RaceState& _state, const Solution& _solution) const
+{
+	for (int i = 0; i < SIMULATION_TURNS; i++)
+	{
+		ComputeWholeTurn(_state, _solution[i]);
+	}
+}
+
+//simulate the turns that are not cached in the solution yet, starting from _state for the first turn
+void Simulation::ComputeSolutionSuffix(Solution& _solution, const RaceState& _state) const
+{
+	const int firstTurn = _solution.firstDirtyTurn;
+	RaceState state = firstTurn == 0 ? _state : _solution.states[firstTurn - 1];
+	for (int i = firstTurn; i < SIMULATION_TURNS; i++)
+	{
+		ComputeWholeTurn(state, _solution[i]);
+		_solution.states[i] = state;
+	}
+	_solution.firstDirtyTurn = SIMULATION_TURNS;
+}
+//expert rule number 1, _moves of the pods 0 to _podCount - 1
+void Simulation::ComputeRotation(RaceState& _state, const Move* _moves, int _podCount) const
+{
+	for (int i = 0; i < _podCount; i++)
+	{
+		const Move& move = _moves[i];
+
+		_state.angle[i] = (_state.angle[i] + move.GetRotation()) % 360;
+	}
+}
+//expert rule number 2
+void Simulation::computeSpeed(RaceState& _state, const Move* _moves, int _podCount) const
+{
+	for (int i = 0; i < _podCount; i++)
+	{
+		const Move& move = _moves[i];
+
+		ManageShield(move.GetUseShield(), _state, i);
+		if (_state.shieldCooldown[i] > 0)
+		{
+			continue;
+		}
+
+		const Vector2& direction = Vector2::FromAngle(_state.angle[i]);
+
+		bool useBoost = false;
+		if (!_state.hasBoosted[i] && move.GetUseBoost())
+		{
+			useBoost = true;
+		}
+		int thrust;
+		if (useBoost)
+		{
+			thrust = THRUST_BOOST;
+			_state.hasBoosted[i] = true;
+		}
+		else
+		{
+			thrust = move.GetThrust();
+		}
+		_state.speedX[i] += (float)thrust * direction.m_x;
+		_state.speedY[i] += (float)thrust * direction.m_y;
+	}
+}
+//absolute time at which pod _i enters its next checkpoint, INFINITY if it does not before _endTime
+float Simulation::NextCheckpointTime(const RaceState& _state, int _i, float _time, float _endTime) const
+{
+	constexpr float checkpointRadiusSquared = CHECKPOINT_RADIUS * CHECKPOINT_RADIUS;
+	const Vector2& checkpoint = m_checkpoints[_state.nextCheckpointId[_i]];
+	const float toCheckpointX = checkpoint.m_x - _state.x[_i];
+	const float toCheckpointY = checkpoint.m_y - _state.y[_i];
+
+	const float c = toCheckpointX * toCheckpointX + toCheckpointY * toCheckpointY - checkpointRadiusSquared;
+	if (c < 0.0f)
+	{
+		return _time;
+	}
+	//squared distance to the circle after s: f(s) = a * s^2 - b * s + c, same equation as TimeToCollision with the checkpoint as a still pod
+	const float a = _state.speedX[_i] * _state.speedX[_i] + _state.speedY[_i] * _state.speedY[_i];
+	const float b = 2.0f * (toCheckpointX * _state.speedX[_i] + toCheckpointY * _state.speedY[_i]);
+	if (a < EPSILON)
+	{
+		return INFINITY;
+	}
+	//The segment enters the circle if it ends inside, or if it gets closest to the checkpoint before its end while crossing the circle.
+	//Most pods are far from their checkpoint: the rejection needs no sqrt and no division
+	const float remainingTime = _endTime - _time;
+	const float endDistance = (a * remainingTime - b) * remainingTime + c;
+	const float delta = b * b - 4.f * a * c;
+	const bool isCrossing = b > 0.0f && b < 2.f * a * remainingTime && delta >= 0.0f;
+	if (endDistance >= 0.0f && !isCrossing)
+	{
+		return INFINITY;
+	}
+	const float entryTime = _time + (b - sqrt(max(delta, 0.0f))) / (2.f * a);
+	return entryTime < _endTime ? entryTime : INFINITY;
+}
+
+//move pod _i in a straight line from the time its position was computed to _time
+inline void MovePod(RaceState& _state, float* _podTimes, int _i, float _time)
+{
+	_state.x[_i] += _state.speedX[_i] * (_time - _podTimes[_i]);
+	_state.y[_i] += _state.speedY[_i] * (_time - _podTimes[_i]);
+	_podTimes[_i] = _time;
+}
+
+//expert rule number 3
+//Event driven: between 2 events, a collision of 2 pods or a pod entering its next checkpoint, the pods move in straight lines.
+//The time of every event is computed once, an event only updates the events of the pods it involves.
+//A pod keeps the time of its position and is only moved when it takes part in an event
+void Simulation::ApplyRotationAndThrust(RaceState& _state) const
+{
+	constexpr float endTime = 1.0f;
+	float podTimes[POD_COUNT] = {};
+	//events 0 to PAIR_COUNT - 1: collision of a pair, then one checkpoint event per pod
+	float eventTimes[PAIR_COUNT + POD_COUNT];
+	for (int k = 0; k < PAIR_COUNT; k++)
+	{
+		eventTimes[k] = NextCollisionTime(_state, PAIR_A[k], PAIR_B[k], 0.0f, endTime);
+	}
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		eventTimes[PAIR_COUNT + i] = NextCheckpointTime(_state, i, 0.0f, endTime);
+	}
+	while (true)
+	{
+		int event = -1;
+		float time = endTime;
+		for (int e = 0; e < PAIR_COUNT + POD_COUNT; e++)
+		{
+			if (eventTimes[e] < time)
+			{
+				time = eventTimes[e];
+				event = e;
+			}
+		}
+		if (event == -1)
+		{
+			break;
+		}
+		if (event >= PAIR_COUNT)
+		{
+			const int i = event - PAIR_COUNT;
+			MovePod(_state, podTimes, i, time);
+			_state.nextCheckpointId[i] = (_state.nextCheckpointId[i] + 1) % m_checkpointCount;
+			_state.totalCheckpointsPassed[i]++;
+			eventTimes[event] = NextCheckpointTime(_state, i, time, endTime);
+			continue;
+		}
+		//the collision times of the other pairs need all the pods at the same time
+		const int podA = PAIR_A[event];
+		const int podB = PAIR_B[event];
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			MovePod(_state, podTimes, i, time);
+		}
+		Rebounce(_state, podA, podB);
+		for (int k = 0; k < PAIR_COUNT; k++)
+		{
+			if (PAIR_A[k] == podA || PAIR_A[k] == podB || PAIR_B[k] == podA || PAIR_B[k] == podB)
+			{
+				eventTimes[k] = NextCollisionTime(_state, PAIR_A[k], PAIR_B[k], time, endTime);
+			}
+		}
+		eventTimes[PAIR_COUNT + podA] = NextCheckpointTime(_state, podA, time, endTime);
+		eventTimes[PAIR_COUNT + podB] = NextCheckpointTime(_state, podB, time, endTime);
+	}
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		MovePod(_state, podTimes, i, endTime);
+	}
+}
+//expert rule number 4
+void Simulation::ApplyFriction(RaceState& _state) const
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		_state.speedX[i] *= FRICTION_FACTOR;
+		_state.speedY[i] *= FRICTION_FACTOR;
+	}
+}
+//expert rule number 5
+void Simulation::FinishTurn(RaceState& _state) const
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		_state.speedX[i] = round(_state.speedX[i]);
+		_state.speedY[i] = round(_state.speedY[i]);
+		_state.x[i] = round(_state.x[i]);
+		_state.y[i] = round(_state.y[i]);
+	}
+}
+
+void Simulation::ComputeWholeTurn(RaceState& _state, const Turn& _turn) const
+{
+	//Application of the "expert rules"
+#if OPPONENT_MODEL
+	const Move moves[POD_COUNT] = { _turn[0], _turn[1], m_opponentModel.GetMove(_state, 2, m_checkpoints), m_opponentModel.GetMove(_state, 3, m_checkpoints) };
+	ComputeRotation(_state, moves, POD_COUNT);
+	computeSpeed(_state, moves, POD_COUNT);
+#else
+	//the opponents coast
+	ComputeRotation(_state, &_turn[0], 2);
+	computeSpeed(_state, &_turn[0], 2);
+#endif
+	ApplyRotationAndThrust(_state);
+	ApplyFriction(_state);
+	FinishTurn(_state);
+}
+
+void Simulation::ComputeWholeTurn(RaceState& _state, const Move (&_moves)[POD_COUNT]) const
+{
+	ComputeRotation(_state, _moves, POD_COUNT);
+	computeSpeed(_state, _moves, POD_COUNT);
+	ApplyRotationAndThrust(_state);
+	ApplyFriction(_state);
+	FinishTurn(_state);
+}
+#pragma endregion SimulationClass
+
+#pragma region BatchSimulation
+//Runs the same expert rules as ComputeWholeTurn on up to BATCH_LANES candidates and fills their cache. _state is the state before the first turn.
+//The candidates are ordered by firstDirtyTurn and each one joins at its own first dirty turn, from its cached state.
+//While fewer than BATCH_MINIMUM_LANES have joined, they are simulated one by one, then all of them in the batch:
+//the lanes of a SIMD register share the same instructions, a lane with no collision left stops moving until all of them have reached the end of the turn.
+//The lanes that have not joined yet are moved as padding and reset when they join.
+//Lanes after _laneCount only pad the last SIMD register: they must have a solution but their result is ignored
+void Simulation::ComputeSolutionBatch(BatchState& _batch, Solution* const* _solutions, int _laneCount, const RaceState& _state) const
+{
+	int joinedCount = 0;
+	int batchTurn = SIMULATION_TURNS;
+	for (int t = _solutions[0]->firstDirtyTurn; t < SIMULATION_TURNS; t++)
+	{
+		for (; joinedCount < _laneCount && _solutions[joinedCount]->firstDirtyTurn == t; joinedCount++)
+		{
+			if (batchTurn < t)
+			{
+				_batch.Insert(joinedCount, _solutions[joinedCount]->states[t - 1]);
+			}
+		}
+		if (batchTurn > t && joinedCount < BATCH_MINIMUM_LANES)
+		{
+			for (int l = 0; l < joinedCount; l++)
+			{
+				Solution& solution = *_solutions[l];
+				RaceState state = t == 0 ? _state : solution.states[t - 1];
+				ComputeWholeTurn(state, solution[t]);
+				solution.states[t] = state;
+			}
+			continue;
+		}
+		if (batchTurn > t)
+		{
+			batchTurn = t;
+			//the kernel never uses a register wider than 8 lanes for 8 candidates or fewer
+			const int paddedCount = _laneCount > BATCH_LANES / 2 ? BATCH_LANES : BATCH_LANES / 2;
+			for (int l = 0; l < paddedCount; l++)
+			{
+				const int turn = max(t, _solutions[l]->firstDirtyTurn);
+				_batch.Insert(l, turn == 0 ? _state : _solutions[l]->states[turn - 1]);
+			}
+		}
+		ComputeWholeTurnBatch(_batch, _solutions, joinedCount, t);
+		for (int l = 0; l < joinedCount; l++)
+		{
+			_batch.Extract(l, _solutions[l]->states[t]);
+		}
+	}
+	for (int l = 0; l < _laneCount; l++)
+	{
+		_solutions[l]->firstDirtyTurn = SIMULATION_TURNS;
+	}
+}
+
+#if BATCH_SIMD
+//libm sqrt sets errno and is never vectorized, the SSE instruction is available for every width
+template<int WIDTH>
+FORCE_INLINE void SqrtLanes(typename Lanes<WIDTH>::Float& _v)
+{
+	typedef float Float4 __attribute__((vector_size(16)));
+	for (int l = 0; l < WIDTH; l += 4)
+	{
+		Float4 chunk;
+		memcpy(&chunk, (const float*)&_v + l, sizeof(chunk));
+		chunk = __builtin_ia32_sqrtps(chunk);
+		memcpy((float*)&_v + l, &chunk, sizeof(chunk));
+	}
+}
+
+//same result as round() for the values of the simulation: (|v| + 0.5) truncated, with the sign of v
+template<int WIDTH>
+FORCE_INLINE void RoundLanes(typename Lanes<WIDTH>::Float& _v)
+{
+	typedef typename Lanes<WIDTH>::Float Float;
+	typedef typename Lanes<WIDTH>::Int Int;
+	const Float magnitude = _v < 0.0f ? -_v : _v;
+	const Float rounded = __builtin_convertvector(__builtin_convertvector(magnitude + 0.5f, Int), Float);
+	_v = _v < 0.0f ? -rounded : rounded;
+}
+
+//absolute time of the next collision between pods _a and _b, same formula as NextCollisionTime without the broad phase
+template<int WIDTH>
+FORCE_INLINE void NextCollisionTimeLanes(const typename Lanes<WIDTH>::Float* _x, const typename Lanes<WIDTH>::Float* _y, const typename Lanes<WIDTH>::Float* _speedX,
+	const typename Lanes<WIDTH>::Float* _speedY, int _a, int _b, const typename Lanes<WIDTH>::Float& _time, typename Lanes<WIDTH>::Float& _collisionTime)
+{
+	typedef typename Lanes<WIDTH>::Float Float;
+	constexpr float podDistanceSquared = 4.0f * POD_RADIUS * POD_RADIUS;
+	const Float zero = {};
+	const Float infinity = zero + INFINITY;
+	const Float positionDifferenceX = _x[_b] - _x[_a];
+	const Float positionDifferenceY = _y[_b] - _y[_a];
+	const Float speedDifferenceX = _speedX[_b] - _speedX[_a];
+	const Float speedDifferenceY = _speedY[_b] - _speedY[_a];
+
+	const Float qa = speedDifferenceX * speedDifferenceX + speedDifferenceY * speedDifferenceY;
+	const Float qb = -2.0f * (positionDifferenceX * speedDifferenceX + positionDifferenceY * speedDifferenceY);
+	const Float qc = positionDifferenceX * positionDifferenceX + positionDifferenceY * positionDifferenceY - podDistanceSquared;
+	const Float delta = qb * qb - 4.f * qa * qc;
+
+	Float sqrtDelta = delta < 0.0f ? zero : delta;
+	SqrtLanes<WIDTH>(sqrtDelta);
+	const Float root = (qb - sqrtDelta) / (2.f * (qa < EPSILON ? zero + EPSILON : qa));
+	Float collisionTime = root > EPSILON ? root : infinity;
+	collisionTime = delta < 0.0f ? infinity : collisionTime;
+	collisionTime = qa < EPSILON ? infinity : collisionTime;
+	collisionTime = _time + collisionTime;
+	_collisionTime = collisionTime < 1.0f ? collisionTime : infinity;
+}
+
+//same formula as NextCheckpointTime, _checkpointId is the next checkpoint of pod _i in each lane
+template<int WIDTH>
+FORCE_INLINE void Simulation::NextCheckpointTimeLanes(const typename Lanes<WIDTH>::Float* _x, const typename Lanes<WIDTH>::Float* _y, const typename Lanes<WIDTH>::Float* _speedX,
+	const typename Lanes<WIDTH>::Float* _speedY, const typename Lanes<WIDTH>::Int& _checkpointId, int _i, const typename Lanes<WIDTH>::Float& _time, typename Lanes<WIDTH>::Float& _entryTime) const
+{
+	typedef typename Lanes<WIDTH>::Float Float;
+	constexpr float checkpointRadiusSquared = CHECKPOINT_RADIUS * CHECKPOINT_RADIUS;
+	const Float zero = {};
+	const Float infinity = zero + INFINITY;
+
+	//select the checkpoint of each lane with blends
+	Float checkpointX = zero;
+	Float checkpointY = zero;
+	for (int c = 0; c < m_checkpointCount; c++)
+	{
+		checkpointX = _checkpointId == c ? zero + m_checkpoints[c].m_x : checkpointX;
+		checkpointY = _checkpointId == c ? zero + m_checkpoints[c].m_y : checkpointY;
+	}
+	const Float toCheckpointX = checkpointX - _x[_i];
+	const Float toCheckpointY = checkpointY - _y[_i];
+
+	const Float qc = toCheckpointX * toCheckpointX + toCheckpointY * toCheckpointY - checkpointRadiusSquared;
+	const Float qa = _speedX[_i] * _speedX[_i] + _speedY[_i] * _speedY[_i];
+	const Float qb = 2.0f * (toCheckpointX * _speedX[_i] + toCheckpointY * _speedY[_i]);
+	const Float remainingTime = 1.0f - _time;
+	const Float endDistance = (qa * remainingTime - qb) * remainingTime + qc;
+	const Float delta = qb * qb - 4.f * qa * qc;
+
+	//0 for the lanes that enter the checkpoint, the sqrt and the division are skipped when no lane does
+	Float rejection = delta < 0.0f ? infinity : zero;
+	rejection = qb <= 0.0f ? infinity : rejection;
+	rejection = qb >= 2.f * qa * remainingTime ? infinity : rejection;
+	rejection = endDistance < 0.0f ? zero : rejection;
+	rejection = qa < EPSILON ? infinity : rejection;
+	rejection = qc < 0.0f ? zero : rejection;
+	bool isAnyEntering = false;
+	for (int l = 0; l < WIDTH; l++)
+	{
+		isAnyEntering |= rejection[l] == 0.0f;
+	}
+	if (!isAnyEntering)
+	{
+		_entryTime = infinity;
+		return;
+	}
+
+	Float sqrtDelta = delta < 0.0f ? zero : delta;
+	SqrtLanes<WIDTH>(sqrtDelta);
+	Float entryTime = _time + (qb - sqrtDelta) / (2.f * (qa < EPSILON ? zero + EPSILON : qa));
+	entryTime = rejection == 0.0f ? entryTime : infinity;
+	entryTime = entryTime < 1.0f ? entryTime : infinity;
+	_entryTime = qc < 0.0f ? _time : entryTime;
+}
+
+//The lane masks are only used right where they are computed, combined masks are scalarized by the compiler
+template<int WIDTH>
+FORCE_INLINE void Simulation::ComputeWholeTurnLanes(BatchState& _batch, const Solution* const* _solutions, int _turn, int _firstLane) const
+{
+	typedef typename Lanes<WIDTH>::Float Float;
+	typedef typename Lanes<WIDTH>::Int Int;
+	const Float zero = {};
+	const Int zeroInt = {};
+
+	Float x[POD_COUNT], y[POD_COUNT], speedX[POD_COUNT], speedY[POD_COUNT];
+	Int nextCheckpointId[POD_COUNT], totalCheckpointsPassed[POD_COUNT], shieldCooldown[POD_COUNT];
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		memcpy(&x[i], &_batch.x[i][_firstLane], sizeof(Float));
+		memcpy(&y[i], &_batch.y[i][_firstLane], sizeof(Float));
+		memcpy(&speedX[i], &_batch.speedX[i][_firstLane], sizeof(Float));
+		memcpy(&speedY[i], &_batch.speedY[i][_firstLane], sizeof(Float));
+		memcpy(&nextCheckpointId[i], &_batch.nextCheckpointId[i][_firstLane], sizeof(Int));
+		memcpy(&totalCheckpointsPassed[i], &_batch.totalCheckpointsPassed[i][_firstLane], sizeof(Int));
+		memcpy(&shieldCooldown[i], &_batch.shieldCooldown[i][_firstLane], sizeof(Int));
+	}
+
+	//expert rules 1 and 2, the moves of the opponents come from their policy
+	for (int i = 0; i < (OPPONENT_MODEL ? POD_COUNT : 2); i++)
+	{
+		//gather the packed moves then unpack them on all the lanes at once
+		int bits[WIDTH];
+		for (int l = 0; l < WIDTH; l++)
+		{
+			if (i < 2)
+			{
+				bits[l] = (*_solutions[_firstLane + l])[_turn][i].GetBits();
+				continue;
+			}
+			const int lane = _firstLane + l;
+			float ourDistanceSquared = INFINITY;
+			for (int j = 0; j < 2; j++)
+			{
+				const float dx = _batch.x[j][lane] - _batch.x[i][lane];
+				const float dy = _batch.y[j][lane] - _batch.y[i][lane];
+				ourDistanceSquared = min(ourDistanceSquared, dx * dx + dy * dy);
+			}
+			bits[l] = m_opponentModel.GetMove(i, _batch.x[i][lane], _batch.y[i][lane], _batch.speedX[i][lane], _batch.speedY[i][lane], _batch.angle[i][lane],
+				m_checkpoints[_batch.nextCheckpointId[i][lane]], _batch.hasBoosted[i][lane] != 0, ourDistanceSquared).GetBits();
+		}
+		Int moves, angle, hasBoosted;
+		memcpy(&moves, bits, sizeof(Int));
+		memcpy(&angle, &_batch.angle[i][_firstLane], sizeof(Int));
+		memcpy(&hasBoosted, &_batch.hasBoosted[i][_firstLane], sizeof(Int));
+		const Int rotation = (moves & Move::ROTATION_MASK) - ROTATION_MAXIMUM;
+		Int thrust = (moves & Move::THRUST_MASK) >> Move::THRUST_SHIFT;
+		const Int useBoost = moves & Move::BOOST_BIT;
+		const Int useShield = moves & Move::SHIELD_BIT;
+
+		//|angle + rotation| stays below 720, this matches % 360
+		angle += rotation;
+		angle = angle >= 360 ? angle - 360 : angle;
+		angle = angle <= -360 ? angle + 360 : angle;
+		memcpy(&_batch.angle[i][_firstLane], &angle, sizeof(Int));
+
+		const Int cooldown = shieldCooldown[i];
+		shieldCooldown[i] = cooldown > 0 ? cooldown - 1 : zeroInt;
+		shieldCooldown[i] = useShield != 0 ? zeroInt + SHIELD_COOLDOWN : shieldCooldown[i];
+
+		//0 when the pod can boost: no shield cooldown, boost requested and not used yet
+		const Int boostBlockers = shieldCooldown[i] | (useBoost ^ Move::BOOST_BIT) | hasBoosted;
+		thrust = boostBlockers == 0 ? zeroInt + THRUST_BOOST : thrust;
+		thrust = shieldCooldown[i] > 0 ? zeroInt : thrust;
+		hasBoosted = boostBlockers == 0 ? zeroInt + 1 : hasBoosted;
+		memcpy(&_batch.hasBoosted[i][_firstLane], &hasBoosted, sizeof(Int));
+
+		float cosines[WIDTH], sines[WIDTH];
+		for (int l = 0; l < WIDTH; l++)
+		{
+			const Vector2& direction = Vector2::FromAngle(_batch.angle[i][_firstLane + l]);
+			cosines[l] = direction.m_x;
+			sines[l] = direction.m_y;
+		}
+		Float directionX, directionY;
+		memcpy(&directionX, cosines, sizeof(Float));
+		memcpy(&directionY, sines, sizeof(Float));
+		const Float thrustLanes = __builtin_convertvector(thrust, Float);
+		speedX[i] += thrustLanes * directionX;
+		speedY[i] += thrustLanes * directionY;
+	}
+
+	//expert rule 3, event driven like ApplyRotationAndThrust: each iteration handles the earliest collision of every lane.
+	//Entering a checkpoint does not change the trajectories, the checkpoint events before the collision are all handled first.
+	//Each pod goes through the same moves as in ApplyRotationAndThrust. The broad phase is not worth a branch here: all the lanes compute every pair
+	Float podTimes[POD_COUNT];
+	Float eventTimes[PAIR_COUNT + POD_COUNT];
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		podTimes[i] = zero;
+		NextCheckpointTimeLanes<WIDTH>(x, y, speedX, speedY, nextCheckpointId[i], i, zero, eventTimes[PAIR_COUNT + i]);
+	}
+	for (int k = 0; k < PAIR_COUNT; k++)
+	{
+		NextCollisionTimeLanes<WIDTH>(x, y, speedX, speedY, PAIR_A[k], PAIR_B[k], zero, eventTimes[k]);
+	}
+	while (true)
+	{
+		Float time = zero + 1.0f;
+		Int event = zeroInt - 1;
+		for (int k = 0; k < PAIR_COUNT; k++)
+		{
+			event = eventTimes[k] < time ? zeroInt + k : event;
+			time = eventTimes[k] < time ? eventTimes[k] : time;
+		}
+
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			Float& checkpointTime = eventTimes[PAIR_COUNT + i];
+			while (true)
+			{
+				const Int isEntering = checkpointTime < time;
+				bool isAnyEntering = false;
+				for (int l = 0; l < WIDTH; l++)
+				{
+					isAnyEntering |= isEntering[l] != 0;
+				}
+				if (!isAnyEntering)
+				{
+					break;
+				}
+				const Float moveTime = checkpointTime < time ? checkpointTime : podTimes[i];
+				x[i] += speedX[i] * (moveTime - podTimes[i]);
+				y[i] += speedY[i] * (moveTime - podTimes[i]);
+				podTimes[i] = moveTime;
+
+				const Int checkpointId = nextCheckpointId[i];
+				const Int followingCheckpointId = checkpointId + 1 == m_checkpointCount ? zeroInt : checkpointId + 1;
+				nextCheckpointId[i] = checkpointTime < time ? followingCheckpointId : checkpointId;
+				totalCheckpointsPassed[i] += checkpointTime < time ? zeroInt + 1 : zeroInt;
+
+				Float entryTime;
+				NextCheckpointTimeLanes<WIDTH>(x, y, speedX, speedY, nextCheckpointId[i], i, moveTime, entryTime);
+				checkpointTime = checkpointTime < time ? entryTime : checkpointTime;
+			}
+		}
+
+		//a collision needs all the pods at the same time, a lane with no collision left moves its pods to the end of the turn
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			x[i] += speedX[i] * (time - podTimes[i]);
+			y[i] += speedY[i] * (time - podTimes[i]);
+			podTimes[i] = time;
+		}
+		bool isAnyColliding = false;
+		for (int l = 0; l < WIDTH; l++)
+		{
+			isAnyColliding |= event[l] >= 0;
+		}
+		if (!isAnyColliding)
+		{
+			break;
+		}
+
+		//rebounce of the colliding pair of each lane, same formula as Rebounce
+		Int podA = zeroInt - 1;
+		Int podB = zeroInt - 1;
+		Float xA = zero, yA = zero, speedXA = zero, speedYA = zero, massA = zero + 1.0f;
+		Float xB = zero, yB = zero, speedXB = zero, speedYB = zero, massB = zero + 1.0f;
+		for (int k = 0; k < PAIR_COUNT; k++)
+		{
+			const int a = PAIR_A[k];
+			const int b = PAIR_B[k];
+			const Float podMassA = shieldCooldown[a] == SHIELD_COOLDOWN ? zero + 10.0f : zero + 1.0f;
+			const Float podMassB = shieldCooldown[b] == SHIELD_COOLDOWN ? zero + 10.0f : zero + 1.0f;
+			podA = event == k ? zeroInt + a : podA;
+			podB = event == k ? zeroInt + b : podB;
+			xA = event == k ? x[a] : xA;
+			yA = event == k ? y[a] : yA;
+			speedXA = event == k ? speedX[a] : speedXA;
+			speedYA = event == k ? speedY[a] : speedYA;
+			massA = event == k ? podMassA : massA;
+			xB = event == k ? x[b] : xB;
+			yB = event == k ? y[b] : yB;
+			speedXB = event == k ? speedX[b] : speedXB;
+			speedYB = event == k ? speedY[b] : speedYB;
+			massB = event == k ? podMassB : massB;
+		}
+		const Float positionDifferenceX = xB - xA;
+		const Float positionDifferenceY = yB - yA;
+		Float distance = positionDifferenceX * positionDifferenceX + positionDifferenceY * positionDifferenceY;
+		SqrtLanes<WIDTH>(distance);
+
+		distance = distance < EPSILON ? zero + EPSILON : distance;
+		const Float dirX = positionDifferenceX / distance;
+		const Float dirY = positionDifferenceY / distance;
+		const Float speedDifferenceX = speedXB - speedXA;
+		const Float speedDifferenceY = speedYB - speedYA;
+
+		const Float mass = (massA * massB) / (massA + massB);
+		const Float dirDotSpeedDiff = speedDifferenceX * dirX + speedDifferenceY * dirY;
+
+		Float impulse = -2.0f * mass * dirDotSpeedDiff;
+		impulse = impulse < -REBOUNCE_MINIMUM_IMPULSE ? zero - REBOUNCE_MINIMUM_IMPULSE : impulse;
+		impulse = impulse > REBOUNCE_MINIMUM_IMPULSE ? zero + REBOUNCE_MINIMUM_IMPULSE : impulse;
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			const Float impulseA = podA == i ? massA * impulse : zero;
+			const Float impulseB = podB == i ? massB * impulse : zero;
+			speedX[i] += (impulseB - impulseA) * dirX;
+			speedY[i] += (impulseB - impulseA) * dirY;
+		}
+
+		//update the events of the pods involved
+		for (int k = 0; k < PAIR_COUNT; k++)
+		{
+			const int a = PAIR_A[k];
+			const int b = PAIR_B[k];
+			Float collisionTime;
+			NextCollisionTimeLanes<WIDTH>(x, y, speedX, speedY, a, b, time, collisionTime);
+			eventTimes[k] = podA == a ? collisionTime : eventTimes[k];
+			eventTimes[k] = podA == b ? collisionTime : eventTimes[k];
+			eventTimes[k] = podB == a ? collisionTime : eventTimes[k];
+			eventTimes[k] = podB == b ? collisionTime : eventTimes[k];
+		}
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			Float entryTime;
+			NextCheckpointTimeLanes<WIDTH>(x, y, speedX, speedY, nextCheckpointId[i], i, time, entryTime);
+			eventTimes[PAIR_COUNT + i] = podA == i ? entryTime : eventTimes[PAIR_COUNT + i];
+			eventTimes[PAIR_COUNT + i] = podB == i ? entryTime : eventTimes[PAIR_COUNT + i];
+		}
+	}
+
+	//expert rules 4 and 5
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		speedX[i] *= FRICTION_FACTOR;
+		speedY[i] *= FRICTION_FACTOR;
+		RoundLanes<WIDTH>(speedX[i]);
+		RoundLanes<WIDTH>(speedY[i]);
+		RoundLanes<WIDTH>(x[i]);
+		RoundLanes<WIDTH>(y[i]);
+
+		memcpy(&_batch.x[i][_firstLane], &x[i], sizeof(Float));
+		memcpy(&_batch.y[i][_firstLane], &y[i], sizeof(Float));
+		memcpy(&_batch.speedX[i][_firstLane], &speedX[i], sizeof(Float));
+		memcpy(&_batch.speedY[i][_firstLane], &speedY[i], sizeof(Float));
+		memcpy(&_batch.nextCheckpointId[i][_firstLane], &nextCheckpointId[i], sizeof(Int));
+		memcpy(&_batch.totalCheckpointsPassed[i][_firstLane], &totalCheckpointsPassed[i], sizeof(Int));
+		memcpy(&_batch.shieldCooldown[i][_firstLane], &shieldCooldown[i], sizeof(Int));
+	}
+}
+
+void Simulation::ComputeWholeTurnAvx512(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const
+{
+	for (int l = 0; l < _laneCount; l += 16)
+	{
+		ComputeWholeTurnLanes<16>(_batch, _solutions, _turn, l);
+	}
+}
+
+void Simulation::ComputeWholeTurnAvx2(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const
+{
+	for (int l = 0; l < _laneCount; l += 8)
+	{
+		ComputeWholeTurnLanes<8>(_batch, _solutions, _turn, l);
+	}
+}
+
+void Simulation::ComputeWholeTurnSse2(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const
+{
+	for (int l = 0; l < _laneCount; l += 4)
+	{
+		ComputeWholeTurnLanes<4>(_batch, _solutions, _turn, l);
+	}
+}
+
+void Simulation::ComputeWholeTurnBatch(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const
+{
+	static const bool hasAvx512 = __builtin_cpu_supports("avx512f");
+	static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+	//a small batch does not fill a wide register, narrower ones waste less work
+	if (hasAvx512 && _laneCount > 8)
+	{
+		ComputeWholeTurnAvx512(_batch, _solutions, _laneCount, _turn);
+	}
+	else if (hasAvx2 && _laneCount > 4)
+	{
+		ComputeWholeTurnAvx2(_batch, _solutions, _laneCount, _turn);
+	}
+	else
+	{
+		ComputeWholeTurnSse2(_batch, _solutions, _laneCount, _turn);
+	}
+}
+#else
+void Simulation::ComputeWholeTurnBatch(BatchState& _batch, const Solution* const* _solutions, int _laneCount, int _turn) const
+{
+	for (int l = 0; l < _laneCount; l++)
+	{
+		RaceState state;
+		_batch.Extract(l, state);
+		ComputeWholeTurn(state, (*_solutions[l])[_turn]);
+		_batch.Insert(l, state);
+	}
+}
+#endif
+#pragma endregion BatchSimulation
+
+void OutputSolution(const Solution& _solution, vector<Pod>& _pods, OutputWriter& _output)
+{
+	constexpr int turn = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		Pod& pod = _pods[i];
+		const Move& move = _solution[turn][i];
+
+		const Vector2& angleDirection = Vector2::FromAngle((pod.angle + move.GetRotation()) % 360);
+
+		constexpr float targetDistance = 10000.0f;
+		Vector2 direction{ targetDistance * angleDirection.GetX(), targetDistance * angleDirection.GetY() };
+		Vector2 target = pod.position + direction;
+
+		_output.Write((int)round(target.GetX()));
+		_output.Write(' ');
+		_output.Write((int)round(target.GetY()));
+		_output.Write(' ');
+		if (move.GetUseShield())
+		{
+			_output.Write("SHIELD SHIELD");
+		}
+		else if (move.GetUseBoost())
+		{
+			_output.Write("BOOST BOOST");
+		}
+		else
+		{
+			_output.Write(move.GetThrust());
+			_output.Write(' ');
+			_output.Write(move.GetThrust());
+		}
+		_output.Write('\n');
+	}
+}
+
+void UpdateShieldAndBoostForNextTurn(const Solution& _solution, vector<Pod>& _pods)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		Pod& pod = _pods[i];
+		const Move& move = _solution[0][i];
+
+		ManageShield(move.GetUseShield(), pod);
+		if (pod.shieldCooldown == 0 && move.GetUseBoost())
+		{
+			pod.hasBoosted = true;
+		}
+	}
+}
+
+//Much faster than std::rand to generate a random number. Each solver owns one so that islands do not share a seed
+class FastRandom
+{
+private:
+	unsigned int m_seed;
+public:
+	FastRandom(unsigned int _seed) : m_seed(_seed) {}
+	inline int Next()
+	{
+		m_seed = (214013 * m_seed + 2531011);
+		return (m_seed >> 16) & 0x7FFF;
+	}
+	//random number in [a, b[
+	inline int Range(int a, int b) { return (Next() % (b - a)) + a; }
+};
+
+#pragma region TimeBudgetClass
+//Clock of the time budget. The time stamp counter costs a few nanoseconds to read where the system clock can cost a syscall.
+//Its frequency is measured against steady_clock at startup and refined at the end of every turn
+class TurnTimer
+{
+private:
+	double m_ticksPerMs;
+	uint64_t m_startTicks = 0;
+	chrono::steady_clock::time_point m_startClock;
+
+	static inline uint64_t Ticks()
+	{
+#if TSC_TIMER
+		return __rdtsc();
+#else
+		return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+public:
+	TurnTimer()
+	{
+		Start();
+		while (chrono::steady_clock::now() - m_startClock < chrono::milliseconds(2))
+		{
+		}
+		m_ticksPerMs = 1.0;
+		Recalibrate();
+	}
+	void Start()
+	{
+		m_startClock = chrono::steady_clock::now();
+		m_startTicks = Ticks();
+	}
+	//milliseconds since Start
+	inline double GetElapsed() const { return (double)(Ticks() - m_startTicks) / m_ticksPerMs; }
+	//measures the tick frequency over the time elapsed since Start
+	void Recalibrate()
+	{
+		const uint64_t ticks = Ticks() - m_startTicks;
+		const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - m_startClock).count();
+		if (ms > 1.0 && ticks > 0)
+		{
+			m_ticksPerMs = (double)ticks / ms;
+		}
+	}
+};
+
+//Decides how many generations the solver can still run this turn.
+//The cost of a generation is a moving mean and deviation measured between two checks, kept from one turn to the next.
+//Generations are only started if they are predicted to end a reserve before the timeout. A stall of the host shows up as a check that comes later
+//than the generations it counts: the reserve is TIMEOUT_RESERVE_MINIMUM plus the longest stall or output time of the last STALL_HISTORY_TURNS turns,
+//leaving out the STALL_IGNORED_TURNS longest
+class TimeBudget
+{
+private:
+	TurnTimer m_timer;
+	double m_timeout = 0.0;
+	double m_deadline = 0.0;
+	double m_costMean = 0.0; //milliseconds per generation
+	double m_costDeviation = 0.0;
+	double m_lastCheck = 0.0;
+	int m_lastGenerations = 0;
+	double m_slack = 0.0;
+	double m_turnStall = 0.0; //longest stall of the current turn
+	double m_stalls[STALL_HISTORY_TURNS] = {}; //ring of the longest stall of the last turns
+	int m_stallCount = 0;
+	double m_reserve = TIMEOUT_RESERVE_START;
+	atomic<bool> m_isInterrupted{ false };
+public:
+	//to call as soon as the turn input starts arriving
+	void StartTurn(int _timeout) { StartTurn(_timeout, m_reserve); }
+	//with a fixed reserve, for the searches that have no output to send
+	void StartTurn(int _timeout, double _reserve)
+	{
+		m_isInterrupted.store(false, memory_order_relaxed);
+		m_timer.Start();
+		m_timeout = _timeout;
+		m_deadline = _timeout - _reserve;
+		m_lastCheck = 0.0;
+		m_lastGenerations = 0;
+		m_turnStall = 0.0;
+	}
+	//number of generations, up to _maximum, that fit before the deadline. _generations is the count run so far this turn
+	int GetAffordableGenerations(int _generations, int _maximum)
+	{
+		const double elapsed = m_timer.GetElapsed();
+		if (_generations > m_lastGenerations)
+		{
+			m_turnStall = max(m_turnStall, elapsed - m_lastCheck - m_costMean * (_generations - m_lastGenerations));
+			const double cost = (elapsed - m_lastCheck) / (_generations - m_lastGenerations);
+			m_costDeviation += BUDGET_COST_SMOOTHING * (fabs(cost - m_costMean) - m_costDeviation);
+			m_costMean += BUDGET_COST_SMOOTHING * (cost - m_costMean);
+		}
+		m_lastCheck = elapsed;
+		m_lastGenerations = _generations;
+		if (IsInterrupted())
+		{
+			return 0;
+		}
+
+		const double predictedCost = m_costMean + BUDGET_COST_DEVIATIONS * m_costDeviation;
+		const double remaining = m_deadline - elapsed;
+		if (remaining <= 0.0)
+		{
+			return 0;
+		}
+		if (predictedCost * _maximum < remaining)
+		{
+			return _maximum;
+		}
+		return min(_maximum, (int)(remaining / predictedCost));
+	}
+	//to call once the output is sent
+	void EndTurn()
+	{
+		const double elapsed = m_timer.GetElapsed();
+		m_slack = m_timeout - elapsed;
+		//the output is written after the last check
+		m_stalls[m_stallCount++ % STALL_HISTORY_TURNS] = max(m_turnStall, elapsed - m_lastCheck);
+		double stalls[STALL_HISTORY_TURNS];
+		const int count = min(m_stallCount, STALL_HISTORY_TURNS);
+		copy(m_stalls, m_stalls + count, stalls);
+		const int rank = min(STALL_IGNORED_TURNS, count - 1);
+		nth_element(stalls, stalls + rank, stalls + count, greater<double>());
+		m_reserve = TIMEOUT_RESERVE_MINIMUM + stalls[rank];
+		m_timer.Recalibrate();
+	}
+	//milliseconds that were left before the timeout when the turn ended
+	double GetSlack() const { return m_slack; }
+	double GetReserve() const { return m_reserve; }
+	double GetGenerationCost() const { return m_costMean; }
+	//ends the turn from another thread, the solver stops after its current generation
+	void Interrupt() { m_isInterrupted.store(true, memory_order_relaxed); }
+	inline bool IsInterrupted() const { return m_isInterrupted.load(memory_order_relaxed); }
+};
+#pragma endregion TimeBudgetClass
+
+#pragma region SearchEngineClass
+//Interface of the searches over the genome. Each engine owns its candidates and its random generator, and is copied through Clone for the pondering.
+//A generation is the work done between two checks of the time budget: SOLUTIONS_COUNT candidates scored by the batch kernel, whatever the engine.
+//The genome operators and the evaluation are shared, the engines only differ by how they pick and keep their candidates
+class SearchEngine
+{
+	friend class Microbenchmark;
+protected:
+	FastRandom m_random;
+	Simulation* m_simulation;
+	//parameters read once, Randomize and RateSolution run for every candidate
+	int m_probRotation;
+	int m_probThrust;
+	int m_probShield;
+	int m_probBoost;
+	float m_aheadBias;
+	float m_firstTurnBoostDistance;
+	int m_generations = 0; //generations run by the last Solve
+
+public:
+	SearchEngine(Simulation* _simulation, unsigned int _seed);
+	virtual ~SearchEngine() {}
+	virtual unique_ptr<SearchEngine> Clone() const = 0;
+	const Solution& Solve(const RaceState& _state, TimeBudget& _budget, int _maxGenerations = INT_MAX);
+	int GetGenerations() const { return m_generations; }
+
+	//steps of Solve, used by IslandSolver to interleave several engines.
+	//_isNewTurn is false when the candidates were already searched for this turn from a predicted state
+	virtual void StartTurn(const RaceState& _state, bool _isNewTurn = true) = 0;
+	virtual void RunGeneration(const RaceState& _state) = 0;
+	virtual const Solution& GetBest() const = 0;
+	//the migrant was scored from the same state
+	virtual void ReceiveMigrant(const Solution& _migrant) = 0;
+
+protected:
+	void InitSolution(Solution& _solution);
+	void RandomizeSolution(Solution& _solution);
+	void Randomize(Move& _move, bool _modifyAll = true);
+	void ShiftByOneTurn(Solution& _solution);
+	void Mutate(Solution& _solution, int _firstTurn = 0);
+	int ComputeScore(Solution& _solution, const RaceState& _state) const;
+	void ComputeScoreBatch(Solution* _solutions, int _count, const RaceState& _state) const;
+	void ComputeScoreBatch(Solution* const* _solutions, int _count, const RaceState& _state) const;
+	int RateSolution(const RaceState& _state) const;
+	static void SortByScore(const vector<Solution>& _solutions, int* _order, int _count);
+};
+
+SearchEngine::SearchEngine(Simulation* _simulation, unsigned int _seed)
+	: m_random(_seed)
+{
+	m_simulation = _simulation;
+	const Parameters& parameters = Parameters::Get();
+	m_probRotation = (int)parameters[PARAMETER_MUTATION_ROTATION_WEIGHT];
+	m_probThrust = m_probRotation + (int)parameters[PARAMETER_MUTATION_THRUST_WEIGHT];
+	m_probShield = m_probThrust + (int)parameters[PARAMETER_MUTATION_SHIELD_WEIGHT];
+	m_probBoost = m_probShield + (int)parameters[PARAMETER_MUTATION_BOOST_WEIGHT];
+	m_aheadBias = parameters[PARAMETER_AHEAD_BIAS];
+	m_firstTurnBoostDistance = parameters[PARAMETER_FIRST_TURN_BOOST_DISTANCE];
+}
+
+const Solution& SearchEngine::Solve(const RaceState& _state, TimeBudget& _budget, int _maxGenerations)
+{
+	StartTurn(_state);
+	//check if I have enough time to run another round of solutions
+	for (m_generations = 0; m_generations < _maxGenerations && _budget.GetAffordableGenerations(m_generations, 1) > 0; m_generations++)
+	{
+		RunGeneration(_state);
+	}
+	return GetBest();
+}
+
+//starting solution of an engine: random moves, and the boost on the first turn when the first checkpoint is far enough
+void SearchEngine::InitSolution(Solution& _solution)
+{
+	RandomizeSolution(_solution);
+	if (m_simulation->GetTrack().segmentLengths[1] >= m_firstTurnBoostDistance)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			_solution[0][i].SetUseBoost(true);
+		}
+	}
+}
+
+void SearchEngine::RandomizeSolution(Solution& _solution)
+{
+	for (int t = 0; t < SIMULATION_TURNS; t++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			Randomize(_solution[t][i]);
+		}
+	}
+	_solution.Invalidate(0);
+}
+#pragma endregion SearchEngineClass
+
+#pragma region GenomeOperators
+//modify one or all of the values of a move
+void SearchEngine::Randomize(Move& _move, bool _modifyAll)
+{
+	constexpr int all = -1, rotation = 0, thrust = 1, shield = 2, boost = 3;
+	const int probRotation = m_probRotation, probThrust = m_probThrust, probShield = m_probShield, probBoost = m_probBoost;
+	//a whole move also draws i: its shield and its boost are only toggled when i falls in their share, as a single mutation would
+	const int i = m_random.Range(0, probBoost);
+	const int valueToModify = [i, _modifyAll, probRotation, probThrust, probShield]() -> int
+	{
+		//i is drawn in [0, probBoost): each value owns the share of the range given by its weight
+		if (_modifyAll)
+			return all;
+		if (i < probRotation)
+			return rotation;
+		if (i < probThrust)
+			return thrust;
+		if (i < probShield)
+			return shield;
+		return boost;
+	}();
+	auto modifyValue = [valueToModify](int parValue)
+	{
+		if (valueToModify == all)
+			return true;
+		return valueToModify == parValue;
+	};
+	if (modifyValue(rotation))
+	{
+		// arbitrarily give more weight to -ROTATION_MAXIMUM, 0, ROTATION_MAXIMUM
+		const int r = m_random.Range(-2 * ROTATION_MAXIMUM, 3 * ROTATION_MAXIMUM);
+		if (r > 2 * ROTATION_MAXIMUM)
+		{
+			_move.SetRotation(0);
+		}
+		else
+		{
+			_move.SetRotation(clamp(r, -ROTATION_MAXIMUM, ROTATION_MAXIMUM));
+		}
+	}
+	if (modifyValue(thrust))
+	{
+		// arbitrarily give more weight to 0, THRUST_MAXIMUM
+		const int r = m_random.Range(-THRUST_MAXIMUM / 2, 2 * THRUST_MAXIMUM);
+		_move.SetThrust(clamp(r, 0, THRUST_MAXIMUM));
+	}
+	if (modifyValue(shield))
+	{
+		if (!_modifyAll || (i >= probThrust && i < probShield))
+		{
+			_move.SetUseShield(!_move.GetUseShield());
+			LOG_DEBUG("shield_toggled", "on", _move.GetUseShield());
+		}
+	}
+	if (modifyValue(boost))
+	{
+		if (!_modifyAll || i >= probShield)
+		{
+			_move.SetUseBoost(!_move.GetUseBoost());
+		}
+	}
+}
+
+void SearchEngine::ShiftByOneTurn(Solution& _solution)
+{
+	for (int t = 1; t < SIMULATION_TURNS; t++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			_solution[t - 1][i] = _solution[t][i];
+		}
+	}
+	//create a new random turn
+	for (int i = 0; i < 2; i++)
+	{
+		Move& move = _solution[SIMULATION_TURNS - 1][i];
+		Randomize(move);
+	}
+}
+
+//_firstTurn keeps the turns before it
+void SearchEngine::Mutate(Solution& _solution, int _firstTurn)
+{
+	//mutate one value with a random t,i
+	int k = m_random.Range(2 * _firstTurn, 2 * SIMULATION_TURNS);
+	Move& move = _solution[k / 2][k % 2];
+
+	Randomize(move, false);
+	_solution.Invalidate(k / 2);
+}
+
+int SearchEngine::ComputeScore(Solution& _solution, const RaceState& _state) const
+{
+	m_simulation->ComputeSolutionSuffix(_solution, _state);
+	_solution.score = RateSolution(_solution.GetFinalState());
+	return _solution.score;
+}
+
+void SearchEngine::ComputeScoreBatch(Solution* _solutions, int _count, const RaceState& _state) const
+{
+	Solution* solutions[2 * SOLUTIONS_COUNT];
+	for (int first = 0; first < _count; first += 2 * SOLUTIONS_COUNT)
+	{
+		const int count = min(2 * SOLUTIONS_COUNT, _count - first);
+		for (int i = 0; i < count; i++)
+		{
+			solutions[i] = &_solutions[first + i];
+		}
+		ComputeScoreBatch(solutions, count, _state);
+	}
+}
+
+void SearchEngine::ComputeScoreBatch(Solution* const* _solutions, int _count, const RaceState& _state) const
+{
+	//the ordering buffer holds 2 * SOLUTIONS_COUNT solutions, larger sets are scored in parts
+	if (_count > 2 * SOLUTIONS_COUNT)
+	{
+		for (int first = 0; first < _count; first += 2 * SOLUTIONS_COUNT)
+		{
+			ComputeScoreBatch(&_solutions[first], min(2 * SOLUTIONS_COUNT, _count - first), _state);
+		}
+		return;
+	}
+	//order the solutions by their first turn to simulate: a lane joins the batch at its own first turn and the clean ones stay out of it
+	Solution* order[2 * SOLUTIONS_COUNT];
+	int orderCount = 0;
+	for (int t = 0; t < SIMULATION_TURNS; t++)
+	{
+		for (int i = 0; i < _count; i++)
+		{
+			if (_solutions[i]->firstDirtyTurn == t)
+			{
+				order[orderCount++] = _solutions[i];
+			}
+		}
+	}
+	for (int first = 0; first < orderCount; first += BATCH_LANES)
+	{
+		const int lanes = min(BATCH_LANES, orderCount - first);
+		//unused lanes replay the last solution of the chunk
+		Solution* lanePointers[BATCH_LANES];
+		BatchState batch;
+		for (int l = 0; l < BATCH_LANES; l++)
+		{
+			lanePointers[l] = order[first + min(l, lanes - 1)];
+		}
+		m_simulation->ComputeSolutionBatch(batch, lanePointers, lanes, _state);
+	}
+	for (int i = 0; i < _count; i++)
+	{
+		_solutions[i]->score = RateSolution(_solutions[i]->GetFinalState());
+	}
+}
+
+int SearchEngine::RateSolution(const RaceState& _state) const
+{
+	//get the score of each pod
+	const TrackModel& track = m_simulation->GetTrack();
+	int scores[POD_COUNT];
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		scores[i] = (int)track.GetRaceProgress(_state, i);
+	}
+
+	int myRacer;
+	//check which of my pods is ahead of the other
+	if (scores[0] > scores[1])
+	{
+		myRacer = 0;
+	}
+	else
+	{
+		myRacer = 1;
+	}
+	const int myInterceptor = 1 - myRacer;
+
+	//check which of the opponent pods is ahead of the other
+	int opponentRacer;
+	if (scores[2] > scores[3])
+	{
+		opponentRacer = 2;
+	}
+	else
+	{
+		opponentRacer = 3;
+	}
+
+	if (_state.totalCheckpointsPassed[myRacer] > m_simulation->GetMaxCheckpoints())
+	{
+		return INT_MAX; //Victory!
+	}
+	if (_state.totalCheckpointsPassed[opponentRacer] > m_simulation->GetMaxCheckpoints())
+	{
+		return INT_MIN; //Defeat!
+	}
+
+	//score difference between my racer and the opponent racer
+	const int aheadScore = scores[myRacer] - scores[opponentRacer];
+
+	//check if my interceptor can block the opponent racer or his destination checkpoint
+	Vector2 opponentCheckpoint = m_simulation->GetCheckpoints()[_state.nextCheckpointId[opponentRacer]];
+	int interceptorScore;
+	if (_state.nextCheckpointId[myRacer] == _state.nextCheckpointId[opponentRacer])
+	{
+		interceptorScore = (int)-Vector2::Distance(_state.GetPosition(myInterceptor), _state.GetPosition(opponentRacer));
+	}
+	else
+	{
+		interceptorScore = (int)-Vector2::Distance(_state.GetPosition(myInterceptor), opponentCheckpoint);
+	}
+
+	return (int)(aheadScore * m_aheadBias) + interceptorScore;
+}
+
+//sorts _order, indices in _solutions, by decreasing score. The solutions stay in place
+void SearchEngine::SortByScore(const vector<Solution>& _solutions, int* _order, int _count)
+{
+	std::sort(_order, _order + _count, [&_solutions](int a, int b)
+		{return _solutions[a].score > _solutions[b].score; });
+}
+#pragma endregion GenomeOperators
+
+#pragma region SolverClass
+//Hill climbing on a population: every solution gets a mutant at each generation, the best SOLUTIONS_COUNT of the parents and the mutants are kept
+class Solver : public SearchEngine
+{
+private:
+	vector<Solution> m_solutions;
+	vector<int> m_order; //indices in m_solutions, sorted by score after each generation
+
+public:
+	Solver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new Solver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_solutions[m_order[0]]; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+};
+
+Solver::Solver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	// m_order[0] to m_order[SOLUTIONS_COUNT - 1] are actual solutions from the previous turn
+	// m_order[SOLUTIONS_COUNT] to m_order[2 * SOLUTIONS_COUNT - 1]: temporary solutions from RunGeneration()
+	m_solutions.resize(2 * SOLUTIONS_COUNT);
+	m_order.resize(2 * SOLUTIONS_COUNT);
+	for (int s = 0; s < 2 * SOLUTIONS_COUNT; s++)
+	{
+		m_order[s] = s;
+	}
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		InitSolution(m_solutions[s]);
+	}
+}
+
+void Solver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	Solution* solutions[SOLUTIONS_COUNT];
+	for (int i = 0; i < SOLUTIONS_COUNT; i++)
+	{
+		solutions[i] = &m_solutions[m_order[i]];
+		if (_isNewTurn)
+		{
+			ShiftByOneTurn(*solutions[i]);
+		}
+		//the cache was computed from another state
+		solutions[i]->Invalidate(0);
+	}
+	ComputeScoreBatch(solutions, SOLUTIONS_COUNT, _state);
+}
+
+void Solver::RunGeneration(const RaceState& _state)
+{
+	//build mutated versions of our solutions
+	Solution* newSolutions[SOLUTIONS_COUNT];
+	for (int i = 0; i < SOLUTIONS_COUNT; ++i)
+	{
+		Solution& newSolution = m_solutions[m_order[SOLUTIONS_COUNT + i]];
+		newSolution = m_solutions[m_order[i]];
+		Mutate(newSolution);
+		newSolutions[i] = &newSolution;
+	}
+	ComputeScoreBatch(newSolutions, SOLUTIONS_COUNT, _state);
+	//sort the solutions by score
+	SortByScore(m_solutions, &m_order[0], 2 * SOLUTIONS_COUNT);
+}
+
+//replace the worst solution of the population
+void Solver::ReceiveMigrant(const Solution& _migrant)
+{
+	Solution& worst = m_solutions[m_order[SOLUTIONS_COUNT - 1]];
+	if (_migrant.score > worst.score)
+	{
+		worst = _migrant;
+		SortByScore(m_solutions, &m_order[0], SOLUTIONS_COUNT);
+	}
+}
+#pragma endregion SolverClass
+
+#pragma region AnnealingSolverClass
+//Simulated annealing: SOLUTIONS_COUNT independent chains, a mutant replaces its chain if it is better,
+//or if it is worse with the Metropolis probability exp(difference / temperature).
+//The temperature falls geometrically over a turn. The length of a turn is not known in generations, the last turn is taken as the estimate:
+//a time based schedule would make the search depend on the clock and break the replay of the traces
+class AnnealingSolver : public SearchEngine
+{
+private:
+	// 0 to (SOLUTIONS_COUNT - 1): the chains, SOLUTIONS_COUNT: the best solution found
+	vector<Solution> m_solutions;
+	vector<Solution> m_mutants;
+	int m_turnGenerations = 0;
+	int m_expectedGenerations = ANNEALING_FIRST_GENERATIONS;
+
+public:
+	AnnealingSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new AnnealingSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_solutions[SOLUTIONS_COUNT]; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+
+private:
+	float GetTemperature() const;
+	void UpdateBest(const Solution& _solution);
+};
+
+AnnealingSolver::AnnealingSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	m_solutions.resize(SOLUTIONS_COUNT + 1);
+	m_mutants.resize(SOLUTIONS_COUNT);
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		InitSolution(m_solutions[s]);
+	}
+	m_solutions[SOLUTIONS_COUNT] = m_solutions[0];
+}
+
+void AnnealingSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	//the pondered generations count in the turn they searched
+	if (_isNewTurn)
+	{
+		m_expectedGenerations = max(m_turnGenerations, 1);
+		m_turnGenerations = 0;
+	}
+	for (Solution& solution : m_solutions)
+	{
+		if (_isNewTurn)
+		{
+			ShiftByOneTurn(solution);
+		}
+		solution.Invalidate(0);
+	}
+	ComputeScoreBatch(&m_solutions[0], SOLUTIONS_COUNT + 1, _state);
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		UpdateBest(m_solutions[s]);
+	}
+}
+
+float AnnealingSolver::GetTemperature() const
+{
+	const float progress = min(1.0f, (float)m_turnGenerations / m_expectedGenerations);
+	return ANNEALING_START_TEMPERATURE * pow(ANNEALING_END_TEMPERATURE / ANNEALING_START_TEMPERATURE, progress);
+}
+
+void AnnealingSolver::RunGeneration(const RaceState& _state)
+{
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		m_mutants[s] = m_solutions[s];
+		Mutate(m_mutants[s]);
+	}
+	ComputeScoreBatch(&m_mutants[0], SOLUTIONS_COUNT, _state);
+	const float temperature = GetTemperature();
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		const Solution& mutant = m_mutants[s];
+		//in float: the scores of a victory and of a defeat are INT_MAX and INT_MIN
+		const float difference = (float)mutant.score - (float)m_solutions[s].score;
+		if (difference >= 0 || m_random.Next() < 32768.0f * exp(difference / temperature))
+		{
+			m_solutions[s] = mutant;
+			UpdateBest(mutant);
+		}
+	}
+	m_turnGenerations++;
+}
+
+//replace the worst chain
+void AnnealingSolver::ReceiveMigrant(const Solution& _migrant)
+{
+	int worst = 0;
+	for (int s = 1; s < SOLUTIONS_COUNT; s++)
+	{
+		if (m_solutions[s].score < m_solutions[worst].score)
+		{
+			worst = s;
+		}
+	}
+	if (_migrant.score > m_solutions[worst].score)
+	{
+		m_solutions[worst] = _migrant;
+		UpdateBest(_migrant);
+	}
+}
+
+void AnnealingSolver::UpdateBest(const Solution& _solution)
+{
+	if (_solution.score > m_solutions[SOLUTIONS_COUNT].score)
+	{
+		m_solutions[SOLUTIONS_COUNT] = _solution;
+	}
+}
+#pragma endregion AnnealingSolverClass
+
+#pragma region GeneticSolverClass
+//Genetic algorithm: a population of GENETIC_POPULATION solutions sorted by score. Each generation breeds SOLUTIONS_COUNT children,
+//from two parents picked by tournament selection, with a uniform crossover of the moves and a mutation.
+//The best GENETIC_POPULATION of the parents and the children survive
+class GeneticSolver : public SearchEngine
+{
+private:
+	vector<Solution> m_solutions;
+	// m_order[0] to m_order[GENETIC_POPULATION - 1]: the population, then the children of the current generation
+	vector<int> m_order;
+
+public:
+	GeneticSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new GeneticSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_solutions[m_order[0]]; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+
+private:
+	const Solution& SelectParent();
+	void Crossover(Solution& _child, const Solution& _parent);
+	void SortPopulation(int _count);
+};
+
+GeneticSolver::GeneticSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	m_solutions.resize(GENETIC_POPULATION + SOLUTIONS_COUNT);
+	m_order.resize(GENETIC_POPULATION + SOLUTIONS_COUNT);
+	for (int s = 0; s < GENETIC_POPULATION + SOLUTIONS_COUNT; s++)
+	{
+		m_order[s] = s;
+	}
+	for (int s = 0; s < GENETIC_POPULATION; s++)
+	{
+		InitSolution(m_solutions[s]);
+	}
+}
+
+void GeneticSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	Solution* solutions[GENETIC_POPULATION];
+	for (int s = 0; s < GENETIC_POPULATION; s++)
+	{
+		solutions[s] = &m_solutions[m_order[s]];
+		if (_isNewTurn)
+		{
+			ShiftByOneTurn(*solutions[s]);
+		}
+		solutions[s]->Invalidate(0);
+	}
+	ComputeScoreBatch(solutions, GENETIC_POPULATION, _state);
+	SortPopulation(GENETIC_POPULATION);
+}
+
+//the population is sorted: the best of GENETIC_TOURNAMENT_SIZE random solutions is the one with the lowest index
+const Solution& GeneticSolver::SelectParent()
+{
+	int best = GENETIC_POPULATION;
+	for (int k = 0; k < GENETIC_TOURNAMENT_SIZE; k++)
+	{
+		best = min(best, m_random.Range(0, GENETIC_POPULATION));
+	}
+	return m_solutions[m_order[best]];
+}
+
+//_child is a copy of the first parent, each move is taken from the second parent with a chance of one half
+void GeneticSolver::Crossover(Solution& _child, const Solution& _parent)
+{
+	static_assert(2 * SIMULATION_TURNS <= 15, "one random number draws the parent of every move");
+	const int bits = m_random.Next();
+	for (int t = 0; t < SIMULATION_TURNS; t++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			if ((bits >> (2 * t + i)) & 1)
+			{
+				Move& move = _child[t][i];
+				if (move.GetBits() != _parent[t][i].GetBits())
+				{
+					move = _parent[t][i];
+					_child.Invalidate(t);
+				}
+			}
+		}
+	}
+}
+
+void GeneticSolver::RunGeneration(const RaceState& _state)
+{
+	Solution* children[SOLUTIONS_COUNT];
+	for (int c = 0; c < SOLUTIONS_COUNT; c++)
+	{
+		Solution& child = m_solutions[m_order[GENETIC_POPULATION + c]];
+		child = SelectParent();
+		Crossover(child, SelectParent());
+		Mutate(child);
+		children[c] = &child;
+	}
+	ComputeScoreBatch(children, SOLUTIONS_COUNT, _state);
+	SortPopulation(GENETIC_POPULATION + SOLUTIONS_COUNT);
+}
+
+//replace the worst solution of the population
+void GeneticSolver::ReceiveMigrant(const Solution& _migrant)
+{
+	Solution& worst = m_solutions[m_order[GENETIC_POPULATION - 1]];
+	if (_migrant.score > worst.score)
+	{
+		worst = _migrant;
+		SortPopulation(GENETIC_POPULATION);
+	}
+}
+
+void GeneticSolver::SortPopulation(int _count)
+{
+	SortByScore(m_solutions, &m_order[0], _count);
+}
+#pragma endregion GeneticSolverClass
+
+#pragma region RestartSolverClass
+//Random-restart hill climbing: SOLUTIONS_COUNT climbers that keep their mutant when it is not worse.
+//A climber that has not improved for RESTART_PATIENCE generations starts again from random moves, the best solution found is kept aside
+class RestartSolver : public SearchEngine
+{
+private:
+	// 0 to (SOLUTIONS_COUNT - 1): the climbers, SOLUTIONS_COUNT: the best solution found
+	vector<Solution> m_solutions;
+	vector<Solution> m_candidates;
+	vector<int> m_stalls; //generations of each climber since its last improvement
+
+public:
+	RestartSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new RestartSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_solutions[SOLUTIONS_COUNT]; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+
+private:
+	void UpdateBest(const Solution& _solution);
+};
+
+RestartSolver::RestartSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	m_solutions.resize(SOLUTIONS_COUNT + 1);
+	m_candidates.resize(SOLUTIONS_COUNT);
+	m_stalls.resize(SOLUTIONS_COUNT);
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		InitSolution(m_solutions[s]);
+	}
+	m_solutions[SOLUTIONS_COUNT] = m_solutions[0];
+}
+
+void RestartSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	for (Solution& solution : m_solutions)
+	{
+		if (_isNewTurn)
+		{
+			ShiftByOneTurn(solution);
+		}
+		solution.Invalidate(0);
+	}
+	ComputeScoreBatch(&m_solutions[0], SOLUTIONS_COUNT + 1, _state);
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		m_stalls[s] = 0;
+		UpdateBest(m_solutions[s]);
+	}
+}
+
+void RestartSolver::RunGeneration(const RaceState& _state)
+{
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		Solution& candidate = m_candidates[s];
+		if (m_stalls[s] >= RESTART_PATIENCE)
+		{
+			RandomizeSolution(candidate);
+		}
+		else
+		{
+			candidate = m_solutions[s];
+			Mutate(candidate);
+		}
+	}
+	ComputeScoreBatch(&m_candidates[0], SOLUTIONS_COUNT, _state);
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		const Solution& candidate = m_candidates[s];
+		const bool isRestarted = m_stalls[s] >= RESTART_PATIENCE;
+		const bool isImproved = candidate.score > m_solutions[s].score;
+		if (isRestarted || candidate.score >= m_solutions[s].score)
+		{
+			m_solutions[s] = candidate;
+			UpdateBest(candidate);
+		}
+		m_stalls[s] = isRestarted || isImproved ? 0 : m_stalls[s] + 1;
+	}
+}
+
+//replace the worst climber
+void RestartSolver::ReceiveMigrant(const Solution& _migrant)
+{
+	int worst = 0;
+	for (int s = 1; s < SOLUTIONS_COUNT; s++)
+	{
+		if (m_solutions[s].score < m_solutions[worst].score)
+		{
+			worst = s;
+		}
+	}
+	if (_migrant.score > m_solutions[worst].score)
+	{
+		m_solutions[worst] = _migrant;
+		m_stalls[worst] = 0;
+		UpdateBest(_migrant);
+	}
+}
+
+void RestartSolver::UpdateBest(const Solution& _solution)
+{
+	if (_solution.score > m_solutions[SOLUTIONS_COUNT].score)
+	{
+		m_solutions[SOLUTIONS_COUNT] = _solution;
+	}
+}
+#pragma endregion RestartSolverClass
+
+#pragma region SmitsimaxSolverClass
+//Smitsimax: a Monte-Carlo tree search with one tree per pod, opponents included, over the moves of GetDiscreteMove.
+//Every iteration each pod picks its move in its own tree with UCB, without knowing the picks of the other pods, the turn is simulated with the 4 moves,
+//and the pods leave their tree at its first new node to play random moves until SIMULATION_TURNS. The final state is rated with RateSolution,
+//our trees maximize it and the trees of the opponents minimize it. The trees are rebuilt every turn, and kept when the pondering was right
+struct SmitsimaxNode
+{
+	int firstChild = -1; //the DISCRETE_MOVE_COUNT children are stored together, child k plays GetDiscreteMove(k)
+	int visits = 0;
+	float totalScore = 0.0f;
+};
+
+class SmitsimaxSolver : public SearchEngine
+{
+private:
+	vector<SmitsimaxNode> m_trees[POD_COUNT]; //node 0 is the root
+	float m_minScore;
+	float m_maxScore;
+	Solution m_best; //the most visited moves of our pods
+
+public:
+	SmitsimaxSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new SmitsimaxSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_best; }
+	//the trees cannot take a solution in
+	void ReceiveMigrant(const Solution&) override {}
+
+private:
+	void ResetTrees();
+	void RunIteration(const RaceState& _state);
+	int SelectChild(int _i, int _node) const;
+	void UpdateBest(const RaceState& _state);
+};
+
+SmitsimaxSolver::SmitsimaxSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	for (vector<SmitsimaxNode>& tree : m_trees)
+	{
+		tree.reserve(SMITSIMAX_MAX_NODES);
+	}
+	ResetTrees();
+	InitSolution(m_best);
+}
+
+void SmitsimaxSolver::ResetTrees()
+{
+	for (vector<SmitsimaxNode>& tree : m_trees)
+	{
+		tree.assign(1, SmitsimaxNode());
+	}
+	m_minScore = INFINITY;
+	m_maxScore = -INFINITY;
+}
+
+void SmitsimaxSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	if (_isNewTurn)
+	{
+		ResetTrees();
+		ShiftByOneTurn(m_best);
+	}
+	m_best.Invalidate(0);
+	ComputeScore(m_best, _state);
+}
+
+void SmitsimaxSolver::RunGeneration(const RaceState& _state)
+{
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		RunIteration(_state);
+	}
+	UpdateBest(_state);
+}
+
+void SmitsimaxSolver::RunIteration(const RaceState& _state)
+{
+	int nodes[POD_COUNT] = {}; //-1 once the pod has left its tree
+	int path[POD_COUNT][SIMULATION_TURNS];
+	int pathLengths[POD_COUNT] = {};
+	RaceState state = _state;
+	for (int t = 0; t < SIMULATION_TURNS; t++)
+	{
+		Move moves[POD_COUNT];
+		for (int i = 0; i < POD_COUNT; i++)
+		{
+			vector<SmitsimaxNode>& tree = m_trees[i];
+			const int node = nodes[i];
+			//a node gets its children on its second visit, while there is room for them
+			if (node >= 0 && tree[node].firstChild < 0 && (node == 0 || tree[node].visits > 0) && tree.size() + DISCRETE_MOVE_COUNT <= SMITSIMAX_MAX_NODES)
+			{
+				tree[node].firstChild = (int)tree.size();
+				tree.resize(tree.size() + DISCRETE_MOVE_COUNT);
+			}
+			int moveIndex;
+			if (node >= 0 && tree[node].firstChild >= 0)
+			{
+				moveIndex = SelectChild(i, node);
+				nodes[i] = tree[node].firstChild + moveIndex;
+				path[i][pathLengths[i]++] = nodes[i];
+			}
+			else
+			{
+				moveIndex = m_random.Range(0, DISCRETE_MOVE_COUNT);
+				nodes[i] = -1;
+			}
+			moves[i] = GetDiscreteMove(moveIndex);
+		}
+		m_simulation->ComputeWholeTurn(state, moves);
+	}
+
+	const float score = (float)RateSolution(state);
+	m_minScore = min(m_minScore, score);
+	m_maxScore = max(m_maxScore, score);
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		vector<SmitsimaxNode>& tree = m_trees[i];
+		tree[0].visits++;
+		for (int d = 0; d < pathLengths[i]; d++)
+		{
+			SmitsimaxNode& node = tree[path[i][d]];
+			node.visits++;
+			node.totalScore += score;
+		}
+	}
+}
+
+//UCB1 on the scores normalized between the lowest and the highest of the turn, reversed for the opponents
+int SmitsimaxSolver::SelectChild(int _i, int _node) const
+{
+	const vector<SmitsimaxNode>& tree = m_trees[_i];
+	const SmitsimaxNode* children = &tree[tree[_node].firstChild];
+	const float range = max(m_maxScore - m_minScore, 1.0f);
+	const float sign = _i < 2 ? 1.0f : -1.0f;
+	const float offset = _i < 2 ? m_minScore : m_maxScore;
+	const float exploration = SMITSIMAX_EXPLORATION * sqrt(log((float)tree[_node].visits));
+	int best = 0;
+	float bestValue = -INFINITY;
+	for (int k = 0; k < DISCRETE_MOVE_COUNT; k++)
+	{
+		const SmitsimaxNode& child = children[k];
+		if (child.visits == 0)
+		{
+			return k;
+		}
+		const float mean = sign * (child.totalScore / child.visits - offset) / range;
+		const float value = mean + exploration / sqrt((float)child.visits);
+		if (value > bestValue)
+		{
+			bestValue = value;
+			best = k;
+		}
+	}
+	return best;
+}
+
+//the turns beyond the explored part of our trees keep the moves of the previous best solution
+void SmitsimaxSolver::UpdateBest(const RaceState& _state)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		const vector<SmitsimaxNode>& tree = m_trees[i];
+		int node = 0;
+		for (int t = 0; t < SIMULATION_TURNS && tree[node].firstChild >= 0; t++)
+		{
+			const int firstChild = tree[node].firstChild;
+			int moveIndex = 0;
+			for (int k = 1; k < DISCRETE_MOVE_COUNT; k++)
+			{
+				if (tree[firstChild + k].visits > tree[firstChild + moveIndex].visits)
+				{
+					moveIndex = k;
+				}
+			}
+			if (tree[firstChild + moveIndex].visits == 0)
+			{
+				break;
+			}
+			const Move move = GetDiscreteMove(moveIndex);
+			if (move.GetBits() != m_best[t][i].GetBits())
+			{
+				m_best[t][i] = move;
+				m_best.Invalidate(t);
+			}
+			node = firstChild + moveIndex;
+		}
+	}
+	if (m_best.firstDirtyTurn < SIMULATION_TURNS)
+	{
+		ComputeScore(m_best, _state);
+	}
+}
+#pragma endregion SmitsimaxSolverClass
+
+#pragma region ExhaustiveSolverClass
+//Exhaustive search of the first EXHAUSTIVE_DEPTH turns: every combination of the moves of GetDiscreteMove for both pods,
+//EXHAUSTIVE_CANDIDATES in all, is scored with the later turns of the best solution, SOLUTIONS_COUNT per generation.
+//The cost of a turn is known in advance, and once it is paid the first move is the best of the coarse move set.
+//The best SOLUTIONS_COUNT candidates are then improved like by Solver, with mutations of the turns after the enumerated ones
+constexpr int CountCombinations(int _turns) { return _turns == 0 ? 1 : DISCRETE_MOVE_COUNT * DISCRETE_MOVE_COUNT * CountCombinations(_turns - 1); }
+constexpr int EXHAUSTIVE_CANDIDATES = CountCombinations(EXHAUSTIVE_DEPTH);
+static_assert(EXHAUSTIVE_DEPTH >= 1 && EXHAUSTIVE_DEPTH < SIMULATION_TURNS, "the mutations need a turn after the enumerated ones");
+
+class ExhaustiveSolver : public SearchEngine
+{
+private:
+	vector<Solution> m_solutions;
+	// m_order[0] to m_order[SOLUTIONS_COUNT - 1]: the best solutions, then the candidates of the current generation
+	vector<int> m_order;
+	int m_nextCandidate = 0; //first combination not scored yet
+
+public:
+	ExhaustiveSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new ExhaustiveSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_solutions[m_order[0]]; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+
+private:
+	void SetCandidate(Solution& _solution, int _candidate) const;
+	void SortSolutions(int _count);
+};
+
+ExhaustiveSolver::ExhaustiveSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	m_solutions.resize(2 * SOLUTIONS_COUNT);
+	m_order.resize(2 * SOLUTIONS_COUNT);
+	for (int s = 0; s < 2 * SOLUTIONS_COUNT; s++)
+	{
+		m_order[s] = s;
+	}
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		InitSolution(m_solutions[s]);
+	}
+}
+
+//the enumeration goes on where it stopped when the pondering was right
+void ExhaustiveSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	if (_isNewTurn)
+	{
+		m_nextCandidate = 0;
+	}
+	Solution* solutions[SOLUTIONS_COUNT];
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		solutions[s] = &m_solutions[m_order[s]];
+		if (_isNewTurn)
+		{
+			ShiftByOneTurn(*solutions[s]);
+		}
+		solutions[s]->Invalidate(0);
+	}
+	ComputeScoreBatch(solutions, SOLUTIONS_COUNT, _state);
+	SortSolutions(SOLUTIONS_COUNT);
+}
+
+//the digits of _candidate in base DISCRETE_MOVE_COUNT are the moves of the enumerated turns
+void ExhaustiveSolver::SetCandidate(Solution& _solution, int _candidate) const
+{
+	for (int t = 0; t < EXHAUSTIVE_DEPTH; t++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			_solution[t][i] = GetDiscreteMove(_candidate % DISCRETE_MOVE_COUNT);
+			_candidate /= DISCRETE_MOVE_COUNT;
+		}
+	}
+	_solution.Invalidate(0);
+}
+
+void ExhaustiveSolver::RunGeneration(const RaceState& _state)
+{
+	Solution* candidates[SOLUTIONS_COUNT];
+	for (int s = 0; s < SOLUTIONS_COUNT; s++)
+	{
+		Solution& candidate = m_solutions[m_order[SOLUTIONS_COUNT + s]];
+		if (m_nextCandidate < EXHAUSTIVE_CANDIDATES)
+		{
+			candidate = m_solutions[m_order[0]];
+			SetCandidate(candidate, m_nextCandidate++);
+		}
+		else
+		{
+			candidate = m_solutions[m_order[s]];
+			Mutate(candidate, EXHAUSTIVE_DEPTH);
+		}
+		candidates[s] = &candidate;
+	}
+	ComputeScoreBatch(candidates, SOLUTIONS_COUNT, _state);
+	SortSolutions(2 * SOLUTIONS_COUNT);
+}
+
+//replace the worst solution
+void ExhaustiveSolver::ReceiveMigrant(const Solution& _migrant)
+{
+	Solution& worst = m_solutions[m_order[SOLUTIONS_COUNT - 1]];
+	if (_migrant.score > worst.score)
+	{
+		worst = _migrant;
+		SortSolutions(SOLUTIONS_COUNT);
+	}
+}
+
+void ExhaustiveSolver::SortSolutions(int _count)
+{
+	SortByScore(m_solutions, &m_order[0], _count);
+}
+#pragma endregion ExhaustiveSolverClass
+
+#pragma region BeamSolverClass
+//Beam search: the beam holds the best solutions planned up to a depth. Each of them is expanded by every pair of moves of GetDiscreteMove for our pods
+//at the next turn, the later turns keep the moves of the solution it comes from and the children are rated with RateSolution at the end of the horizon.
+//The best m_width children with different pod positions and speeds at the expanded turn make the next beam, SIMULATION_TURNS times.
+//The width is chosen when the turn starts so that one pass fits in the generations of the last turn, a pass finished early is followed by a wider one.
+//Every child is a whole solution: the best one scored is kept and the search can stop at any generation
+class BeamSolver : public SearchEngine
+{
+private:
+	static constexpr int MOVE_PAIRS = DISCRETE_MOVE_COUNT * DISCRETE_MOVE_COUNT;
+
+	Solution m_best;
+	vector<Solution> m_beam; //solutions expanded at m_depth
+	vector<Solution> m_next; //best children found at m_depth
+	vector<uint64_t> m_nextKeys; //hash of the pods at m_depth of each solution of m_next
+	vector<Solution> m_children; //SOLUTIONS_COUNT children of the current generation
+	int m_worstNext = 0; //index of the lowest score of m_next
+	int m_depth = 0;
+	int m_parent = 0; //next solution of m_beam to expand
+	int m_movePair = 0; //next pair of moves to expand it with
+	int m_width = 1;
+	int m_turnGenerations = 0;
+	int m_expectedGenerations = BEAM_FIRST_GENERATIONS;
+
+public:
+	BeamSolver(Simulation* _simulation, unsigned int _seed = SOLVER_SEED);
+	unique_ptr<SearchEngine> Clone() const override { return unique_ptr<SearchEngine>(new BeamSolver(*this)); }
+	void StartTurn(const RaceState& _state, bool _isNewTurn = true) override;
+	void RunGeneration(const RaceState& _state) override;
+	const Solution& GetBest() const override { return m_best; }
+	void ReceiveMigrant(const Solution& _migrant) override;
+
+private:
+	void StartPass();
+	void KeepChild(const Solution& _child);
+	static uint64_t HashPods(const RaceState& _state);
+	static bool IsSamePods(const RaceState& _a, const RaceState& _b);
+};
+
+BeamSolver::BeamSolver(Simulation* _simulation, unsigned int _seed)
+	: SearchEngine(_simulation, _seed)
+{
+	InitSolution(m_best);
+	m_children.resize(SOLUTIONS_COUNT);
+}
+
+void BeamSolver::StartTurn(const RaceState& _state, bool _isNewTurn)
+{
+	//the pondered generations count in the turn they searched
+	if (_isNewTurn)
+	{
+		m_expectedGenerations = max(m_turnGenerations, 1);
+		m_turnGenerations = 0;
+		ShiftByOneTurn(m_best);
+		//a pass expands 1 solution at the first turn and m_width at each of the other turns, MOVE_PAIRS children each
+		const int passParents = m_expectedGenerations * SOLUTIONS_COUNT / MOVE_PAIRS;
+		m_width = clamp((passParents - 1) / max(SIMULATION_TURNS - 1, 1), 1, BEAM_MAXIMUM_WIDTH);
+	}
+	m_best.Invalidate(0);
+	ComputeScore(m_best, _state);
+	StartPass();
+}
+
+//the first beam is the best solution, its later turns are the plan of the previous turns
+void BeamSolver::StartPass()
+{
+	m_beam.assign(1, m_best);
+	m_next.clear();
+	m_nextKeys.clear();
+	m_worstNext = 0;
+	m_depth = 0;
+	m_parent = 0;
+	m_movePair = 0;
+}
+
+void BeamSolver::RunGeneration(const RaceState& _state)
+{
+	//once the whole beam is expanded, the last child is repeated to fill the batch
+	bool isDepthDone = false;
+	for (int c = 0; c < SOLUTIONS_COUNT; c++)
+	{
+		Solution& child = m_children[c];
+		child = m_beam[m_parent];
+		child[m_depth][0] = GetDiscreteMove(m_movePair % DISCRETE_MOVE_COUNT);
+		child[m_depth][1] = GetDiscreteMove(m_movePair / DISCRETE_MOVE_COUNT);
+		child.Invalidate(m_depth);
+		if (m_movePair < MOVE_PAIRS - 1)
+		{
+			m_movePair++;
+		}
+		else if (m_parent < (int)m_beam.size() - 1)
+		{
+			m_movePair = 0;
+			m_parent++;
+		}
+		else
+		{
+			isDepthDone = true;
+		}
+	}
+	ComputeScoreBatch(&m_children[0], SOLUTIONS_COUNT, _state);
+	for (const Solution& child : m_children)
+	{
+		if (child.score > m_best.score)
+		{
+			m_best = child;
+		}
+		KeepChild(child);
+	}
+	m_turnGenerations++;
+
+	if (!isDepthDone)
+	{
+		return;
+	}
+	if (++m_depth == SIMULATION_TURNS)
+	{
+		m_width = min(2 * m_width, BEAM_MAXIMUM_WIDTH);
+		StartPass();
+		return;
+	}
+	m_beam.swap(m_next);
+	m_next.clear();
+	m_nextKeys.clear();
+	m_worstNext = 0;
+	m_parent = 0;
+	m_movePair = 0;
+}
+
+//keeps the m_width best children, a child with the pods of a kept one at the expanded turn takes its place only if it is better
+void BeamSolver::KeepChild(const Solution& _child)
+{
+	const RaceState& pods = _child.states[m_depth];
+	const uint64_t key = HashPods(pods);
+	int slot = -1;
+	for (int n = 0; n < (int)m_next.size() && slot < 0; n++)
+	{
+		if (m_nextKeys[n] == key && IsSamePods(m_next[n].states[m_depth], pods))
+		{
+			slot = n;
+		}
+	}
+	if (slot < 0 && (int)m_next.size() < m_width)
+	{
+		m_next.push_back(_child);
+		m_nextKeys.push_back(key);
+	}
+	else
+	{
+		slot = slot < 0 ? m_worstNext : slot;
+		if (_child.score <= m_next[slot].score)
+		{
+			return;
+		}
+		m_next[slot] = _child;
+		m_nextKeys[slot] = key;
+	}
+	for (int n = 0; n < (int)m_next.size(); n++)
+	{
+		if (m_next[n].score < m_next[m_worstNext].score)
+		{
+			m_worstNext = n;
+		}
+	}
+}
+
+uint64_t BeamSolver::HashPods(const RaceState& _state)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		const int64_t fields[4] = { (int64_t)_state.x[i], (int64_t)_state.y[i], (int64_t)_state.speedX[i], (int64_t)_state.speedY[i] };
+		for (int64_t field : fields)
+		{
+			hash = (hash ^ (uint64_t)field) * 1099511628211ull;
+		}
+	}
+	return hash;
+}
+
+bool BeamSolver::IsSamePods(const RaceState& _a, const RaceState& _b)
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		if (_a.x[i] != _b.x[i] || _a.y[i] != _b.y[i] || _a.speedX[i] != _b.speedX[i] || _a.speedY[i] != _b.speedY[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//the migrant can only replace the best solution
+void BeamSolver::ReceiveMigrant(const Solution& _migrant)
+{
+	if (_migrant.score > m_best.score)
+	{
+		m_best = _migrant;
+	}
+}
+#pragma endregion BeamSolverClass
+
+#pragma region SearchEngineFactory
+enum SearchEngineType
+{
+	ENGINE_HILL_CLIMBING,
+	ENGINE_ANNEALING,
+	ENGINE_GENETIC,
+	ENGINE_RESTART,
+	ENGINE_SMITSIMAX,
+	ENGINE_EXHAUSTIVE,
+	ENGINE_BEAM,
+	ENGINE_COUNT
+};
+
+//names of the engines for "--engine NAME"
+const char* const SEARCH_ENGINE_NAMES[ENGINE_COUNT] = { "hill", "annealing", "genetic", "restart", "smitsimax", "exhaustive", "beam" };
+
+//ENGINE_COUNT if _name is not an engine
+SearchEngineType FindSearchEngine(const char* _name)
+{
+	int type = 0;
+	while (type < ENGINE_COUNT && strcmp(_name, SEARCH_ENGINE_NAMES[type]) != 0)
+	{
+		type++;
+	}
+	return (SearchEngineType)type;
+}
+
+unique_ptr<SearchEngine> CreateSearchEngine(SearchEngineType _type, Simulation* _simulation, unsigned int _seed)
+{
+	switch (_type)
+	{
+	case ENGINE_ANNEALING:
+		return unique_ptr<SearchEngine>(new AnnealingSolver(_simulation, _seed));
+	case ENGINE_GENETIC:
+		return unique_ptr<SearchEngine>(new GeneticSolver(_simulation, _seed));
+	case ENGINE_RESTART:
+		return unique_ptr<SearchEngine>(new RestartSolver(_simulation, _seed));
+	case ENGINE_SMITSIMAX:
+		return unique_ptr<SearchEngine>(new SmitsimaxSolver(_simulation, _seed));
+	case ENGINE_EXHAUSTIVE:
+		return unique_ptr<SearchEngine>(new ExhaustiveSolver(_simulation, _seed));
+	case ENGINE_BEAM:
+		return unique_ptr<SearchEngine>(new BeamSolver(_simulation, _seed));
+	default:
+		return unique_ptr<SearchEngine>(new Solver(_simulation, _seed));
+	}
+}
+#pragma endregion SearchEngineFactory
+
+#pragma region IslandSolverClass
+//Barrier for the threads of one Solve call. The generations between two migrations only last some dozens of microseconds: waiting threads spin instead of sleeping
+class SpinBarrier
+{
+private:
+	const int m_count;
+	atomic<int> m_waiting{ 0 };
+	atomic<int> m_phase{ 0 };
+public:
+	SpinBarrier(int _count) : m_count(_count) {}
+	void Wait()
+	{
+		const int phase = m_phase.load(memory_order_acquire);
+		if (m_waiting.fetch_add(1, memory_order_acq_rel) + 1 == m_count)
+		{
+			m_waiting.store(0, memory_order_relaxed);
+			m_phase.store(phase + 1, memory_order_release);
+			return;
+		}
+		while (m_phase.load(memory_order_acquire) == phase)
+		{
+			this_thread::yield();
+		}
+	}
+};
+
+//result of the pondering of the previous turn
+enum PonderOutcome
+{
+	PONDER_NONE,
+	PONDER_DISCARDED,
+	PONDER_KEPT
+};
+
+//Island model: several independent search engines, each with its own random generator, spread over a pool of threads.
+//Every MIGRATION_GENERATIONS generations the best solution of each island replaces the worst one of the next island.
+//Islands do not depend on the thread that runs them: with a generation limit the result only depends on the seed and the island count
+class IslandSolver
+{
+private:
+	vector<unique_ptr<SearchEngine>> m_islands;
+	vector<Solution> m_migrants;
+	int m_threadCount;
+	vector<thread> m_workers;
+
+	//a new turn is published to the workers under the mutex
+	mutex m_mutex;
+	condition_variable m_turnStarted;
+	int m_turnId = 0;
+	bool m_isStopping = false;
+
+	//parameters of the current turn
+	const RaceState* m_state = nullptr;
+	TimeBudget* m_budget = nullptr;
+	int m_maxGenerations = 0;
+	SpinBarrier m_barrier;
+	int m_epochGenerations = 0; //written by thread 0 between two barriers
+	vector<int> m_islandGenerations; //generations run by each island in the current epoch
+	vector<int> m_generationLog; //epochs of the last Solve, see RecordEpoch
+
+	//pondering: a thread runs Solve on the predicted state until the next input arrives
+	thread m_ponderThread;
+	TimeBudget m_ponderBudget;
+	RaceState m_predictedState;
+	vector<unique_ptr<SearchEngine>> m_snapshot; //islands before pondering, restored if the prediction was wrong
+	bool m_isPondered = false; //the islands were searched for the current turn
+	vector<int> m_ponderLog; //epochs of the last pondering
+
+public:
+	IslandSolver(Simulation* _simulation, int _threadCount = SOLVER_THREADS, int _islandCount = SOLVER_ISLANDS, unsigned int _seed = SOLVER_SEED,
+		SearchEngineType _engine = SEARCH_ENGINE);
+	~IslandSolver();
+	const Solution& Solve(const RaceState& _state, TimeBudget& _budget, int _maxGenerations = INT_MAX);
+	void StartPondering(const RaceState& _predictedState);
+	PonderOutcome StopPondering(const RaceState& _state);
+	//no more threads than islands
+	int GetThreadCount() const { return m_threadCount; }
+
+	//the generations run by each island, to search a recorded turn again
+	const vector<int>& GetGenerationLog() const { return m_generationLog; }
+	const vector<int>& GetPonderLog() const { return m_ponderLog; }
+	const Solution& Replay(const RaceState& _state, const vector<int>& _generationLog);
+	PonderOutcome ReplayPondering(const RaceState& _predictedState, const RaceState& _state, const vector<int>& _generationLog);
+
+private:
+	const Solution& GetBest() const;
+	void SavePrediction(const RaceState& _predictedState);
+	PonderOutcome KeepOrRestore(const RaceState& _state);
+	bool MatchesPrediction(const RaceState& _state) const;
+	int GetEpochGenerations(int _generation);
+	void WorkerLoop(int _thread);
+	void SolveTurn(int _thread);
+	void RecordEpoch();
+	void Migrate();
+};
+
+IslandSolver::IslandSolver(Simulation* _simulation, int _threadCount, int _islandCount, unsigned int _seed, SearchEngineType _engine)
+	: m_threadCount(max(1, min(_threadCount, _islandCount))), m_barrier(m_threadCount)
+{
+	for (int i = 0; i < _islandCount; i++)
+	{
+		m_islands.push_back(CreateSearchEngine(_engine, _simulation, _seed + 7919 * i));
+	}
+	m_migrants.resize(_islandCount);
+	m_islandGenerations.resize(_islandCount);
+	//the calling thread works as thread 0
+	for (int t = 1; t < m_threadCount; t++)
+	{
+		m_workers.emplace_back(&IslandSolver::WorkerLoop, this, t);
+	}
+}
+
+IslandSolver::~IslandSolver()
+{
+	if (m_ponderThread.joinable())
+	{
+		m_ponderBudget.Interrupt();
+		m_ponderThread.join();
+	}
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_turnStarted.notify_all();
+	for (thread& worker : m_workers)
+	{
+		worker.join();
+	}
 }
-//Try to use the boost on the first turn
-void Solver::FirstTurnBoost()
+
+const Solution& IslandSolver::Solve(const RaceState& _state, TimeBudget& _budget, int _maxGenerations)
 {
-	float distance = pow(Vector2::Distance(m_simulation->GetCheckpoints()[0], m_simulation->GetCheckpoints()[1]), 2);
-	float boostDistanceThreshold = 9000000.f;
-	if (distance < boostDistanceThreshold)
+	m_state = &_state;
+	m_budget = &_budget;
+	m_maxGenerations = _maxGenerations;
+	m_generationLog.clear();
 	{
-		return;
+		lock_guard<mutex> lock(m_mutex);
+		m_turnId++;
 	}
-	for (int i = 0; i < 2; i++)
+	m_turnStarted.notify_all();
+	SolveTurn(0);
+	m_isPondered = false;
+	//the workers are done with the islands after the last barrier
+	return GetBest();
+}
+
+//runs the epochs of a generation log on the calling thread, the islands end up as after the recorded Solve
+const Solution& IslandSolver::Replay(const RaceState& _state, const vector<int>& _generationLog)
+{
+	const int islandCount = (int)m_islands.size();
+	for (const unique_ptr<SearchEngine>& island : m_islands)
+	{
+		island->StartTurn(_state, !m_isPondered);
+	}
+	for (size_t run = 0; run + islandCount < _generationLog.size(); run += islandCount + 1)
 	{
-		for (int s = 0; s < SOLUTIONS_COUNT; s++)
+		for (int epoch = 0; epoch < _generationLog[run]; epoch++)
 		{
-			m_solutions[s][0][i].useBoost = true;
+			for (int i = 0; i < islandCount; i++)
+			{
+				for (int g = 0; g < _generationLog[run + 1 + i]; g++)
+				{
+					m_islands[i]->RunGeneration(_state);
+				}
+			}
+			Migrate();
 		}
 	}
+	m_generationLog = _generationLog;
+	m_isPondered = false;
+	return GetBest();
 }
-//modify one or all of the values of a move
-void Solver::Randomize(Move& _move, bool _modifyAll) const
+
+const Solution& IslandSolver::GetBest() const
 {
-	constexpr int all = -1, rotation = 0, thrust = 1, shield = 2, boost = 3;
-	constexpr int probRotation = 5, probThrust = probRotation + 5, probShield = probThrust + 1, probBoost = probShield + 0;
-	int i;
-	if (_modifyAll)
+	const SearchEngine* best = m_islands[0].get();
+	for (const unique_ptr<SearchEngine>& island : m_islands)
 	{
-		i = -1;
+		if (island->GetBest().score > best->GetBest().score)
+		{
+			best = island.get();
+		}
 	}
-	else
+	return best->GetBest();
+}
+
+void IslandSolver::WorkerLoop(int _thread)
+{
+	int turnId = 0;
+	while (true)
 	{
-		i = rnd(0, probBoost);
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_turnStarted.wait(lock, [this, turnId]() { return m_isStopping || m_turnId != turnId; });
+			if (m_isStopping)
+			{
+				return;
+			}
+			turnId = m_turnId;
+		}
+		SolveTurn(_thread);
 	}
-	const int valueToModify = [i, _modifyAll]() -> int
+}
+
+void IslandSolver::SolveTurn(int _thread)
+{
+	const int islandCount = (int)m_islands.size();
+	for (int i = _thread; i < islandCount; i += m_threadCount)
 	{
-		if (_modifyAll)
-			return true;
-		if (i <= probRotation)
-			return rotation;
-		if (i <= probThrust)
-			return thrust;
-		if (i <= probShield)
-			return shield;
-		return boost;
-	}();
-	auto modifyValue = [valueToModify](int parValue)
+		m_islands[i]->StartTurn(*m_state, !m_isPondered);
+	}
+	//the first barrier makes sure every thread has left the previous turn before the epoch length is written
+	m_barrier.Wait();
+	if (_thread == 0)
 	{
-		if (valueToModify == all)
-			return true;
-		return valueToModify == parValue;
-	};
-	if (modifyValue(rotation))
+		m_epochGenerations = GetEpochGenerations(0);
+	}
+	m_barrier.Wait();
+	int generation = 0;
+	while (m_epochGenerations > 0)
 	{
-		// arbitrarily give more weight to -ROTATION_MAXIMUM, 0, ROTATION_MAXIMUM
-		const int r = rnd(-2 * ROTATION_MAXIMUM, 3 * ROTATION_MAXIMUM);
-		if (r > 2 * ROTATION_MAXIMUM)
+		const int epochGenerations = m_epochGenerations;
+		for (int i = _thread; i < islandCount; i += m_threadCount)
 		{
-			_move.rotation = 0;
+			int g = 0;
+			for (; g < epochGenerations && !m_budget->IsInterrupted(); g++)
+			{
+				m_islands[i]->RunGeneration(*m_state);
+			}
+			m_islandGenerations[i] = g;
 		}
-		else
+		generation += epochGenerations;
+
+		m_barrier.Wait();
+		if (_thread == 0)
 		{
-			_move.rotation = clamp(r, -ROTATION_MAXIMUM, ROTATION_MAXIMUM);
+			RecordEpoch();
+			Migrate();
+			m_epochGenerations = GetEpochGenerations(generation);
 		}
+		m_barrier.Wait();
 	}
-	if (modifyValue(thrust))
+}
+
+//the last epochs of a turn get shorter so that the deadline is not overrun by a whole epoch
+int IslandSolver::GetEpochGenerations(int _generation)
+{
+	return m_budget->GetAffordableGenerations(_generation, min(MIGRATION_GENERATIONS, m_maxGenerations - _generation));
+}
+
+//to call once the output is sent: the islands are searched for the next turn in the background
+void IslandSolver::StartPondering(const RaceState& _predictedState)
+{
+	SavePrediction(_predictedState);
+	m_ponderBudget.StartTurn(INT_MAX);
+	m_ponderThread = thread([this]()
+		{
+			//the pondering only runs on a processor nothing else wants: the referee reading our output and our next turn come first.
+			//The change of class does not give the processor away before the next tick, the yield does
+#ifdef __linux__
+			sched_param parameters = {};
+			sched_setscheduler(0, SCHED_IDLE, &parameters);
+			sched_yield();
+#endif
+			Solve(m_predictedState, m_ponderBudget);
+		});
+}
+
+//to call once the input is read: stops the background search and keeps it only if the prediction was right
+PonderOutcome IslandSolver::StopPondering(const RaceState& _state)
+{
+	if (!m_ponderThread.joinable())
 	{
-		// arbitrarily give more weight to 0, THRUST_MAXIMUM
-		const int r = rnd(-THRUST_MAXIMUM / 2, 2 * THRUST_MAXIMUM);
-		_move.thrust = clamp(r, 0, THRUST_MAXIMUM);
+		return PONDER_NONE;
 	}
-	if (modifyValue(shield))
+	m_ponderBudget.Interrupt();
+	m_ponderThread.join();
+	return KeepOrRestore(_state);
+}
+
+//pondering with the generations of a recorded one, on the calling thread
+PonderOutcome IslandSolver::ReplayPondering(const RaceState& _predictedState, const RaceState& _state, const vector<int>& _generationLog)
+{
+	SavePrediction(_predictedState);
+	Replay(m_predictedState, _generationLog);
+	return KeepOrRestore(_state);
+}
+
+void IslandSolver::SavePrediction(const RaceState& _predictedState)
+{
+	m_predictedState = _predictedState;
+	m_snapshot.clear();
+	for (const unique_ptr<SearchEngine>& island : m_islands)
 	{
-		if (!_modifyAll || (rnd(0, 10) > 6))
-		{
-			cerr << "Shield on" << endl;
-			_move.useShield = !_move.useShield;
-		}
+		m_snapshot.push_back(island->Clone());
 	}
-	if (modifyValue(boost))
+}
+
+PonderOutcome IslandSolver::KeepOrRestore(const RaceState& _state)
+{
+	m_ponderLog = m_generationLog;
+	m_isPondered = MatchesPrediction(_state);
+	if (!m_isPondered)
 	{
-		if (!_modifyAll || (rnd(0, 10) > 6))
+		for (size_t i = 0; i < m_islands.size(); i++)
 		{
-			_move.useBoost = !_move.useBoost;
+			m_islands[i] = move(m_snapshot[i]);
 		}
 	}
+	return m_isPondered ? PONDER_KEPT : PONDER_DISCARDED;
 }
 
-void Solver::ShiftByOneTurn(Solution& _solution) const
+//only our pods are compared: the opponents were predicted by their fitted model and can be elsewhere.
+//That does not make the kept search wrong, StartTurn rescores the kept population from the real state, opponents included
+bool IslandSolver::MatchesPrediction(const RaceState& _state) const
 {
-	for (int t = 1; t < SIMULATION_TURNS; t++)
+	const RaceState& predicted = m_predictedState;
+	for (int i = 0; i < 2; i++)
 	{
-		for (int i = 0; i < 2; i++)
+		if (fabs(_state.x[i] - predicted.x[i]) > PONDER_TOLERANCE || fabs(_state.y[i] - predicted.y[i]) > PONDER_TOLERANCE
+			|| fabs(_state.speedX[i] - predicted.speedX[i]) > PONDER_TOLERANCE || fabs(_state.speedY[i] - predicted.speedY[i]) > PONDER_TOLERANCE
+			|| _state.nextCheckpointId[i] != predicted.nextCheckpointId[i])
 		{
-			_solution[t - 1][i] = _solution[t][i];
+			return false;
 		}
 	}
-	//create a new random turn
-	for (int i = 0; i < 2; i++)
+	return true;
+}
+
+//Every epoch is followed by a migration. Identical consecutive epochs are stored once:
+//the number of epochs, then the generations run by each island
+void IslandSolver::RecordEpoch()
+{
+	const int islandCount = (int)m_islands.size();
+	const size_t size = m_generationLog.size();
+	if (size > 0 && equal(m_islandGenerations.begin(), m_islandGenerations.end(), m_generationLog.end() - islandCount))
 	{
-		Move& move = _solution[SIMULATION_TURNS - 1][i];
-		Randomize(move);
+		m_generationLog[size - islandCount - 1]++;
+		return;
 	}
+	m_generationLog.push_back(1);
+	m_generationLog.insert(m_generationLog.end(), m_islandGenerations.begin(), m_islandGenerations.end());
 }
 
-void Solver::Mutate(Solution& _solution) const
+//ring topology: island i receives the best solution of island i - 1
+void IslandSolver::Migrate()
 {
-	//mutate one value with a random t,i
-	int k = rnd(0, 2 * SIMULATION_TURNS);
-	Move& move = _solution[k / 2][k % 2];
+	const int islandCount = (int)m_islands.size();
+	if (islandCount < 2)
+	{
+		return;
+	}
+	for (int i = 0; i < islandCount; i++)
+	{
+		m_migrants[i] = m_islands[i]->GetBest();
+	}
+	for (int i = 0; i < islandCount; i++)
+	{
+		m_islands[i]->ReceiveMigrant(m_migrants[(i + islandCount - 1) % islandCount]);
+	}
+}
+#pragma endregion IslandSolverClass
 
-	Randomize(move, false);
+#pragma region Trace
+//Binary trace of a game, written by the bot started with "--record FILE" and read by Replayer.cpp to search any turn again.
+//Integers are LEB128 varints, zigzag encoded when they can be negative. Pod inputs are stored as deltas from the previous turn
+//and checkpoints as deltas from the previous checkpoint.
+//Header: magic, SIMULATION_TURNS, SOLUTIONS_COUNT, solver seed, island count, thread count, search engine, parameters (float bits), laps, checkpoints.
+//Turn: pod inputs, ponder outcome, ponder generation log, generation log, best score, moves of our pods, slack (us), generation cost (ns)
+#define TRACE_MAGIC "RCT3"
+#define TRACE_POD_FIELDS 6
+
+struct TraceHeader
+{
+	int simulationTurns = 0;
+	int solutionsCount = 0;
+	unsigned int seed = 0;
+	int islandCount = 0;
+	int threadCount = 0;
+	SearchEngineType engine = ENGINE_HILL_CLIMBING;
+	vector<float> parameters;
+	int laps = 0;
+	vector<Vector2> checkpoints;
+};
+
+struct TraceTurn
+{
+	TurnInput input;
+	PonderOutcome ponderOutcome = PONDER_NONE;
+	vector<int> ponderLog;
+	vector<int> generationLog;
+	int score = 0;
+	uint16_t moves[2] = {};
+	int slack = 0; //microseconds
+	int generationCost = 0; //nanoseconds
+};
+
+inline void GetPodFields(const TurnInput& _input, int _fields[POD_COUNT * TRACE_POD_FIELDS])
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		const PodInput& pod = _input.pods[i];
+		int* fields = &_fields[i * TRACE_POD_FIELDS];
+		fields[0] = pod.x;
+		fields[1] = pod.y;
+		fields[2] = pod.speedX;
+		fields[3] = pod.speedY;
+		fields[4] = pod.angle;
+		fields[5] = pod.nextCheckpointId;
+	}
 }
 
-int Solver::ComputeScore(Solution& _solution, const vector<Pod>& _pods) const
+inline void SetPodFields(TurnInput& _input, const int _fields[POD_COUNT * TRACE_POD_FIELDS])
 {
-	vector<Pod> podsCopy = _pods;
-	m_simulation->ComputeSolution(podsCopy, _solution);
-	_solution.score = RateSolution(podsCopy);
-	return _solution.score;
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		PodInput& pod = _input.pods[i];
+		const int* fields = &_fields[i * TRACE_POD_FIELDS];
+		pod.x = fields[0];
+		pod.y = fields[1];
+		pod.speedX = fields[2];
+		pod.speedY = fields[3];
+		pod.angle = fields[4];
+		pod.nextCheckpointId = fields[5];
+	}
 }
 
-int Solver::RateSolution(vector<Pod>& _pods) const
+//the turns are written once the output is sent, a game cut short keeps all of its complete turns
+class TraceWriter
 {
-	//get the score of each pod
-	auto podScore = [&](const Pod& _pod) -> int
+private:
+	FILE* m_file = nullptr;
+	vector<uint8_t> m_buffer;
+	int m_previous[POD_COUNT * TRACE_POD_FIELDS] = {};
+
+	void WriteUnsigned(uint32_t _value)
 	{
-		constexpr int cpFactor = 30000;
-		const int distToCp = (int)Vector2::Distance(_pod.position, m_simulation->GetCheckpoints()[_pod.nextCheckpointId]);
-		return cpFactor * _pod.totalCheckpointsPassed - distToCp;
-	};
-	for (Pod& pod : _pods)
+		while (_value >= 0x80)
+		{
+			m_buffer.push_back((uint8_t)(_value | 0x80));
+			_value >>= 7;
+		}
+		m_buffer.push_back((uint8_t)_value);
+	}
+	void WriteSigned(int _value) { WriteUnsigned(((uint32_t)_value << 1) ^ (uint32_t)(_value >> 31)); }
+	void WriteLog(const vector<int>& _log)
+	{
+		WriteUnsigned((uint32_t)_log.size());
+		for (int value : _log)
+		{
+			WriteUnsigned((uint32_t)value);
+		}
+	}
+	void Flush()
+	{
+		fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+		fflush(m_file);
+		m_buffer.clear();
+	}
+public:
+	~TraceWriter()
+	{
+		if (m_file != nullptr)
+		{
+			fclose(m_file);
+		}
+	}
+	bool Open(const char* _path)
 	{
-		pod.score = podScore(pod);
+		m_file = fopen(_path, "wb");
+		return m_file != nullptr;
 	}
+	bool IsOpen() const { return m_file != nullptr; }
+	void WriteHeader(const Simulation& _simulation, unsigned int _seed, int _islandCount, int _threadCount, SearchEngineType _engine);
+	void WriteTurn(const TurnInput& _input, PonderOutcome _ponderOutcome, const vector<int>& _ponderLog, const vector<int>& _generationLog,
+		const Solution& _solution, double _slack, double _generationCost);
+};
 
-	int myRacerIndex;
-	//check which of my pods is ahead of the other
-	if (_pods[0].score > _pods[1].score)
+void TraceWriter::WriteHeader(const Simulation& _simulation, unsigned int _seed, int _islandCount, int _threadCount, SearchEngineType _engine)
+{
+	m_buffer.insert(m_buffer.end(), TRACE_MAGIC, TRACE_MAGIC + 4);
+	WriteUnsigned(SIMULATION_TURNS);
+	WriteUnsigned(SOLUTIONS_COUNT);
+	WriteUnsigned(_seed);
+	WriteUnsigned((uint32_t)_islandCount);
+	WriteUnsigned((uint32_t)_threadCount);
+	WriteUnsigned((uint32_t)_engine);
+	WriteUnsigned(PARAMETER_COUNT);
+	for (int i = 0; i < PARAMETER_COUNT; i++)
 	{
-		myRacerIndex = 0;
+		const float value = Parameters::Get()[(ParameterId)i];
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		WriteUnsigned(bits);
 	}
-	else
+	const vector<Vector2>& checkpoints = _simulation.GetCheckpoints();
+	WriteUnsigned((uint32_t)(_simulation.GetMaxCheckpoints() / checkpoints.size()));
+	WriteUnsigned((uint32_t)checkpoints.size());
+	int previousX = 0, previousY = 0;
+	for (const Vector2& checkpoint : checkpoints)
 	{
-		myRacerIndex = 1;
+		WriteSigned((int)checkpoint.GetX() - previousX);
+		WriteSigned((int)checkpoint.GetY() - previousY);
+		previousX = (int)checkpoint.GetX();
+		previousY = (int)checkpoint.GetY();
 	}
-	Pod& myRacer = _pods[myRacerIndex];
-	Pod& myInterceptor = _pods[1 - myRacerIndex];
+	Flush();
+}
 
-	//check which of the opponent pods is ahead of the other
-	Pod opponentRacer;
-	if (_pods[2].score > _pods[3].score)
+void TraceWriter::WriteTurn(const TurnInput& _input, PonderOutcome _ponderOutcome, const vector<int>& _ponderLog, const vector<int>& _generationLog,
+	const Solution& _solution, double _slack, double _generationCost)
+{
+	int fields[POD_COUNT * TRACE_POD_FIELDS];
+	GetPodFields(_input, fields);
+	for (int f = 0; f < POD_COUNT * TRACE_POD_FIELDS; f++)
 	{
-		opponentRacer = _pods[2];
+		WriteSigned(fields[f] - m_previous[f]);
+		m_previous[f] = fields[f];
 	}
-	else
+	WriteUnsigned((uint32_t)_ponderOutcome);
+	WriteLog(_ponderOutcome == PONDER_NONE ? vector<int>() : _ponderLog);
+	WriteLog(_generationLog);
+	WriteSigned(_solution.score);
+	for (int i = 0; i < 2; i++)
 	{
-		opponentRacer = _pods[3];
+		WriteUnsigned(_solution[0][i].GetBits());
 	}
+	WriteSigned((int)(_slack * 1000.0));
+	WriteUnsigned((uint32_t)(_generationCost * 1000000.0));
+	Flush();
+}
+
+class TraceReader
+{
+private:
+	vector<uint8_t> m_data;
+	size_t m_position = 0;
+	bool m_isTruncated = false;
+	int m_previous[POD_COUNT * TRACE_POD_FIELDS] = {};
 
-	if (myRacer.totalCheckpointsPassed > m_simulation->GetMaxCheckpoints())
+	uint32_t ReadUnsigned()
+	{
+		uint32_t value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (m_position >= m_data.size())
+			{
+				m_isTruncated = true;
+				return 0;
+			}
+			const uint8_t byte = m_data[m_position++];
+			value |= (uint32_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				break;
+			}
+		}
+		return value;
+	}
+	int ReadSigned()
 	{
-		return (int)INFINITY; //Victory!
+		const uint32_t value = ReadUnsigned();
+		return (int)(value >> 1) ^ -(int)(value & 1);
 	}
-	if (opponentRacer.totalCheckpointsPassed > m_simulation->GetMaxCheckpoints())
+	void ReadLog(vector<int>& _log)
 	{
-		return (int)INFINITY; //Defeat!
+		const uint32_t size = ReadUnsigned();
+		_log.clear();
+		for (uint32_t i = 0; i < size && !m_isTruncated; i++)
+		{
+			_log.push_back((int)ReadUnsigned());
+		}
 	}
+public:
+	bool Open(const char* _path);
+	bool ReadHeader(TraceHeader& _header);
+	bool ReadTurn(TraceTurn& _turn);
+};
 
-	//score difference between my racer and the opponent racer
-	const int aheadScore = myRacer.score - opponentRacer.score;
+bool TraceReader::Open(const char* _path)
+{
+	FILE* file = fopen(_path, "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	uint8_t block[65536];
+	size_t count;
+	while ((count = fread(block, 1, sizeof(block), file)) > 0)
+	{
+		m_data.insert(m_data.end(), block, block + count);
+	}
+	fclose(file);
+	return true;
+}
 
-	//check if my interceptor can block the opponent racer or his destination checkpoint
-	Vector2 opponentCheckpoint = m_simulation->GetCheckpoints()[opponentRacer.nextCheckpointId];
-	int interceptorScore;
-	if (myRacer.nextCheckpointId == opponentRacer.nextCheckpointId)
+bool TraceReader::ReadHeader(TraceHeader& _header)
+{
+	if (m_data.size() < 4 || memcmp(m_data.data(), TRACE_MAGIC, 4) != 0)
 	{
-		interceptorScore = (int)-Vector2::Distance(myInterceptor.position, opponentRacer.position);
+		return false;
 	}
-	else
+	m_position = 4;
+	_header.simulationTurns = (int)ReadUnsigned();
+	_header.solutionsCount = (int)ReadUnsigned();
+	_header.seed = ReadUnsigned();
+	_header.islandCount = (int)ReadUnsigned();
+	_header.threadCount = (int)ReadUnsigned();
+	_header.engine = (SearchEngineType)min(ReadUnsigned(), (uint32_t)ENGINE_COUNT);
+	_header.parameters.resize(ReadUnsigned());
+	for (float& value : _header.parameters)
+	{
+		const uint32_t bits = ReadUnsigned();
+		memcpy(&value, &bits, sizeof(value));
+	}
+	_header.laps = (int)ReadUnsigned();
+	_header.checkpoints.resize(ReadUnsigned());
+	int x = 0, y = 0;
+	for (Vector2& checkpoint : _header.checkpoints)
 	{
-		interceptorScore = (int)-Vector2::Distance(myInterceptor.position, opponentCheckpoint);
+		x += ReadSigned();
+		y += ReadSigned();
+		checkpoint = Vector2((float)x, (float)y);
 	}
+	return !m_isTruncated;
+}
 
-	constexpr int aheadBias = 2; // being ahead is better than blocking the opponent
-	return aheadScore * aheadBias + interceptorScore;
+//false at the end of the trace or on a truncated turn
+bool TraceReader::ReadTurn(TraceTurn& _turn)
+{
+	if (m_position >= m_data.size())
+	{
+		return false;
+	}
+	int fields[POD_COUNT * TRACE_POD_FIELDS];
+	for (int f = 0; f < POD_COUNT * TRACE_POD_FIELDS; f++)
+	{
+		fields[f] = m_previous[f] + ReadSigned();
+		m_previous[f] = fields[f];
+	}
+	SetPodFields(_turn.input, fields);
+	_turn.ponderOutcome = (PonderOutcome)ReadUnsigned();
+	ReadLog(_turn.ponderLog);
+	ReadLog(_turn.generationLog);
+	_turn.score = ReadSigned();
+	for (int i = 0; i < 2; i++)
+	{
+		_turn.moves[i] = (uint16_t)ReadUnsigned();
+	}
+	_turn.slack = ReadSigned();
+	_turn.generationCost = (int)ReadUnsigned();
+	return !m_isTruncated;
 }
-#pragma endregion SolverClass
+#pragma endregion Trace
 
 //makes pods face the checkpoint on the first turn
 void OverrideAngle(Pod& _pod, Vector2& _target)
 {
 	Vector2 dir = Vector2::Normalize(_target - _pod.position);
-	float a = acos(dir.GetX()) * 180.f / PI;
-	if (dir.GetY() < 0)
+	_pod.angle = Vector2::GetClosestAngle(dir);
+}
+
+//loads the input of a turn in the pods
+void UpdatePods(vector<Pod>& _pods, const TurnInput& _input, bool _isFirstTurn, Vector2& _firstCheckpoint)
+{
+	for (int i = 0; i < POD_COUNT; i++)
 	{
-		a = (360.f - a);
+		UpdatePodInfo(_pods[i], _input.pods[i]);
+		if (_isFirstTurn)
+		{
+			OverrideAngle(_pods[i], _firstCheckpoint);
+		}
 	}
-	_pod.angle = (int)a;
 }
 
-int main()
+//tools include this file to reuse the simulation, they define RENDUCODE_NO_MAIN
+#ifndef RENDUCODE_NO_MAIN
+//arguments: "--seed N" for the solver, "--engine NAME" for its search (see SEARCH_ENGINE_NAMES), "--threads N" and "--islands N" for the island model
+//(one island per thread by default), "--record FILE" to write a trace of the game, and the ones of Parameters
+int main(int argc, char** argv)
 {
-	Simulation simulation;
-	Vector2 firstCheckpoint = simulation.InitCheckpoints();
-	Solver solver{ &simulation };
-	vector<Pod> pods(4);
-	int step = 0;
-	while (1)
+	bool isListRequested = false;
+	const char* recordPath = nullptr;
+	unsigned int seed = SOLVER_SEED;
+	SearchEngineType engine = SEARCH_ENGINE;
+	int threadCount = SOLVER_THREADS;
+	int islandCount = 0;
+	for (int a = 1; a < argc; a++)
 	{
-		for (int i = 0; i < 4; i++)
+		const char* argument = argv[a];
+		if (strcmp(argument, "--record") == 0 && a + 1 < argc)
 		{
-			UpdatePodInfo(pods[i]);
-			if (step == 0)
-			{
-				OverrideAngle(pods[i], firstCheckpoint);
-			}
+			recordPath = argv[++a];
 		}
-		int availableTime = 0;
-		if (step == 0)
+		else if (strcmp(argument, "--seed") == 0 && a + 1 < argc)
 		{
-			availableTime = TIMEOUT_FIRST_TURN;
-
+			seed = (unsigned int)strtoul(argv[++a], nullptr, 10);
+		}
+		else if (strcmp(argument, "--engine") == 0 && a + 1 < argc && FindSearchEngine(argv[a + 1]) != ENGINE_COUNT)
+		{
+			engine = FindSearchEngine(argv[++a]);
+		}
+		else if (strcmp(argument, "--threads") == 0 && a + 1 < argc)
+		{
+			threadCount = max(1, atoi(argv[++a]));
+		}
+		else if (strcmp(argument, "--islands") == 0 && a + 1 < argc)
+		{
+			islandCount = max(1, atoi(argv[++a]));
+		}
+		else if (!Parameters::Get().ParseArgument(argc, argv, a, isListRequested))
+		{
+			LOG_ERROR("invalid_argument", "argument", argument);
+			LOG_FLUSH();
+			return 1;
+		}
+	}
+	if (isListRequested)
+	{
+		Parameters::Get().Print();
+		return 0;
+	}
+	InputReader input;
+	OutputWriter output;
+	Simulation simulation;
+	Vector2 firstCheckpoint = simulation.InitCheckpoints(input);
+	if (islandCount == 0)
+	{
+		islandCount = threadCount == SOLVER_THREADS ? SOLVER_ISLANDS : threadCount;
+	}
+	IslandSolver solver{ &simulation, threadCount, islandCount, seed, engine };
+	TraceWriter trace;
+	if (recordPath != nullptr)
+	{
+		if (trace.Open(recordPath))
+		{
+			trace.WriteHeader(simulation, seed, islandCount, solver.GetThreadCount(), engine);
 		}
 		else
 		{
-			availableTime = TIMEOUT;
+			LOG_ERROR("trace_not_opened", "path", recordPath);
+		}
+	}
+	TimeBudget budget;
+	vector<Pod> pods(4);
+	TurnInput turnInput;
+	RaceState previousState;
+	int step = 0;
+	//the turn timer of the referee runs from the moment the input is sent, it is started before the input is parsed
+	while (input.WaitForInput())
+	{
+		budget.StartTurn(step == 0 ? TIMEOUT_FIRST_TURN : TIMEOUT);
+		if (!input.ReadTurn(turnInput))
+		{
+			break;
 		}
-		float timeoutSafeGuard = 0.95f;
+		UpdatePods(pods, turnInput, step == 0, firstCheckpoint);
 
-		const Solution& solution = solver.Solve(pods, (int)(availableTime * timeoutSafeGuard));
-		OutputSolution(solution, pods);
+		RaceState state;
+		state.Load(pods);
+		const PonderOutcome ponderOutcome = solver.StopPondering(state);
+#if OPPONENT_MODEL
+		//the pondering simulates the opponents, their model is fitted once it has stopped
+		if (step > 0)
+		{
+			simulation.ObserveOpponents(previousState, pods);
+			state.Load(pods);
+		}
+		previousState = state;
+#endif
+		const Solution& solution = solver.Solve(state, budget);
+		OutputSolution(solution, pods, output);
+		output.Flush();
 		UpdateShieldAndBoostForNextTurn(solution, pods);
+		budget.EndTurn();
+		if (trace.IsOpen())
+		{
+			trace.WriteTurn(turnInput, ponderOutcome, solver.GetPonderLog(), solver.GetGenerationLog(), solution, budget.GetSlack(), budget.GetGenerationCost());
+		}
+		LOG_INFO("turn", "step", step, "slack_ms", budget.GetSlack(), "reserve_ms", budget.GetReserve(), "generation_us", budget.GetGenerationCost() * 1000.0);
+		LOG_FLUSH();
+#if PONDERING
+		//the best solution is overwritten by the pondering, its cache holds the state predicted after our move
+		solver.StartPondering(solution.states[0]);
+#endif
 		++step;
 	}
-}
\ No newline at end of file
+}
+#endif
@@ -2,19 +2,38 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <cstdint>
 #include <cmath>
+#include <type_traits>
+
+//the input and output go straight to the file descriptors, without iostream
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 #define CHECKPOINT_RADIUS 600
 #define POD_RADIUS 400
 
+//defaults of the parameters that can be changed at run time, see Parameters.
+//A header exported by Tuner.cpp replaces them when it is included first (g++ -include TunedParameters.h)
+#ifndef BRAKING_DISTANCE
 #define BRAKING_DISTANCE 1800 //distance to slow down when approaching in a straight line
+#endif
 #define TURNING_DISTANCE 2400 //distance to start slowing down when using steering
 
+#ifndef STEERING_FACTOR
 #define STEERING_FACTOR 150.0f
+#endif
+#ifndef BOOSTINGSAFEZONE
 #define BOOSTINGSAFEZONE 4000 //distance where the pod can boost without hitting the opponent
+#endif
 
 #define THRUST_MINIMUM 0.0f
 #define THRUST_MAXIMUM 100
@@ -22,6 +41,18 @@ using namespace std;
 
 #define SHIELD_COOLDOWN 4 // turn of activation + 3 turns of inactivity
 
+//log levels: records above LOG_LEVEL are removed at compile time and their arguments are not evaluated
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+//records of a turn are kept in a ring buffer of this size and written once the output is sent
+#define LOG_BUFFER_SIZE 4096
+
 #define PI 3.14159265f
 #define DEG2RAD(angle) ((angle) * PI / 180.0f)
 #define RAD2DEG(angle) ((angle) * 180.0f / PI)
@@ -145,6 +176,409 @@ struct Checkpoint
 	int x;
 	int y;
 };
+
+#pragma region Logger
+//Records are one line each: level, event, then key=value fields. They are formatted into a fixed ring buffer
+//and written to stderr in one go by Flush, when the oldest records have been overwritten a line tells how much was lost
+class Logger
+{
+private:
+	char m_buffer[LOG_BUFFER_SIZE];
+	size_t m_size = 0; //bytes recorded since the last flush, the buffer holds the last LOG_BUFFER_SIZE of them
+
+	void Append(char _c) { m_buffer[m_size++ % LOG_BUFFER_SIZE] = _c; }
+	void Append(const char* _text)
+	{
+		while (*_text)
+		{
+			Append(*_text++);
+		}
+	}
+	void AppendValue(const char* _text) { Append(_text); }
+	template<typename T>
+	void AppendValue(const T& _value)
+	{
+		char text[32];
+		if (is_floating_point<T>::value)
+		{
+			snprintf(text, sizeof(text), "%.3f", (double)_value);
+		}
+		else
+		{
+			snprintf(text, sizeof(text), "%lld", (long long)_value);
+		}
+		Append(text);
+	}
+	void AppendFields() {}
+	template<typename T, typename... Fields>
+	void AppendFields(const char* _key, const T& _value, const Fields&... _fields)
+	{
+		Append(' ');
+		Append(_key);
+		Append('=');
+		AppendValue(_value);
+		AppendFields(_fields...);
+	}
+public:
+	static Logger& Get()
+	{
+		static Logger logger;
+		return logger;
+	}
+	template<typename... Fields>
+	void Record(const char* _level, const char* _event, const Fields&... _fields)
+	{
+		Append(_level);
+		Append(' ');
+		Append(_event);
+		AppendFields(_fields...);
+		Append('\n');
+	}
+	void Flush()
+	{
+		if (m_size > LOG_BUFFER_SIZE)
+		{
+			const size_t start = m_size % LOG_BUFFER_SIZE;
+			char header[64];
+			snprintf(header, sizeof(header), "WARN log dropped=%lld\n", (long long)(m_size - LOG_BUFFER_SIZE));
+			cerr.write(header, strlen(header));
+			cerr.write(m_buffer + start, LOG_BUFFER_SIZE - start);
+			cerr.write(m_buffer, start);
+		}
+		else
+		{
+			cerr.write(m_buffer, m_size);
+		}
+		m_size = 0;
+	}
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::Get().Record("ERROR", __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) Logger::Get().Record("WARN", __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::Get().Record("INFO", __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::Get().Record("DEBUG", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_LEVEL > LOG_LEVEL_NONE
+#define LOG_FLUSH() Logger::Get().Flush()
+#else
+#define LOG_FLUSH() ((void)0)
+#endif
+#pragma endregion Logger
+
+#pragma region Parameters
+//Constants that can be changed at run time, for the tuner. A bot started with "--parameters FILE" (one "NAME VALUE" per line)
+//or "--set NAME=VALUE" uses these values instead of the defines of the same name, "--list-parameters" prints them with their range
+struct ParameterDefinition
+{
+	const char* name;
+	float value; //the default value
+	float minimum;
+	float maximum;
+	bool isInteger;
+};
+
+enum ParameterId
+{
+	PARAMETER_BRAKING_DISTANCE,
+	PARAMETER_STEERING_FACTOR,
+	PARAMETER_BOOSTINGSAFEZONE,
+	PARAMETER_COUNT
+};
+
+const ParameterDefinition PARAMETER_DEFINITIONS[PARAMETER_COUNT] =
+{
+	{ "BRAKING_DISTANCE", BRAKING_DISTANCE, 0.0f, 6000.0f, true },
+	{ "STEERING_FACTOR", STEERING_FACTOR, 0.0f, 1000.0f, false },
+	{ "BOOSTINGSAFEZONE", BOOSTINGSAFEZONE, 0.0f, 10000.0f, true },
+};
+
+class Parameters
+{
+private:
+	float m_values[PARAMETER_COUNT];
+
+	Parameters()
+	{
+		for (int i = 0; i < PARAMETER_COUNT; i++)
+		{
+			m_values[i] = PARAMETER_DEFINITIONS[i].value;
+		}
+	}
+public:
+	static Parameters& Get()
+	{
+		static Parameters parameters;
+		return parameters;
+	}
+	float operator[](ParameterId _id) const { return m_values[_id]; }
+	bool Set(const char* _name, float _value);
+	bool Load(const char* _path);
+	bool ParseArguments(int _argc, char** _argv, bool& _isListRequested);
+	void Print() const;
+};
+
+//the value is clamped to the range of the parameter
+bool Parameters::Set(const char* _name, float _value)
+{
+	for (int i = 0; i < PARAMETER_COUNT; i++)
+	{
+		const ParameterDefinition& definition = PARAMETER_DEFINITIONS[i];
+		if (strcmp(definition.name, _name) == 0)
+		{
+			const float value = clip(_value, definition.minimum, definition.maximum);
+			m_values[i] = definition.isInteger ? roundf(value) : value;
+			return true;
+		}
+	}
+	LOG_ERROR("unknown_parameter", "name", _name);
+	return false;
+}
+
+//empty lines and lines starting with # are skipped
+bool Parameters::Load(const char* _path)
+{
+	FILE* file = fopen(_path, "r");
+	if (file == nullptr)
+	{
+		LOG_ERROR("parameters_not_found", "path", _path);
+		return false;
+	}
+	bool isValid = true;
+	char line[256];
+	while (isValid && fgets(line, sizeof(line), file) != nullptr)
+	{
+		char name[128];
+		float value;
+		if (line[0] == '#' || sscanf(line, "%127s", name) != 1)
+		{
+			continue;
+		}
+		isValid = sscanf(line, "%127s %f", name, &value) == 2 && Set(name, value);
+	}
+	fclose(file);
+	return isValid;
+}
+
+bool Parameters::ParseArguments(int _argc, char** _argv, bool& _isListRequested)
+{
+	for (int a = 1; a < _argc; a++)
+	{
+		const char* argument = _argv[a];
+		if (strcmp(argument, "--parameters") == 0 && a + 1 < _argc)
+		{
+			if (!Load(_argv[++a]))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(argument, "--set") == 0 && a + 1 < _argc)
+		{
+			char name[128];
+			float value;
+			if (sscanf(_argv[++a], "%127[^=]=%f", name, &value) != 2 || !Set(name, value))
+			{
+				return false;
+			}
+		}
+		else if (strcmp(argument, "--list-parameters") == 0)
+		{
+			_isListRequested = true;
+		}
+		else
+		{
+			LOG_ERROR("unknown_argument", "argument", argument);
+			return false;
+		}
+	}
+	return true;
+}
+
+void Parameters::Print() const
+{
+	for (int i = 0; i < PARAMETER_COUNT; i++)
+	{
+		const ParameterDefinition& definition = PARAMETER_DEFINITIONS[i];
+		printf("parameter name=%s value=%g minimum=%g maximum=%g integer=%d\n",
+			definition.name, m_values[i], definition.minimum, definition.maximum, definition.isInteger ? 1 : 0);
+	}
+}
+#pragma endregion Parameters
+
+#pragma region InputOutput
+inline long ReadDescriptor(int _fd, char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+	return _read(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)read(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+inline long WriteDescriptor(int _fd, const char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+	return _write(_fd, _buffer, (unsigned int)_size);
+#else
+	return (long)write(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+//one line of the turn input
+struct PodInput
+{
+	int x, y, speedX, speedY, angle, nextCheckpointId;
+};
+
+struct TurnInput
+{
+	PodInput pods[4];
+};
+
+//Reads the referee input in large blocks and parses the integers in place, with no locale and no stdio synchronization.
+//The input of a whole turn usually arrives with a single read
+class InputReader
+{
+private:
+	static constexpr int BUFFER_SIZE = 1 << 16;
+	int m_fd;
+	vector<char> m_buffer;
+	const char* m_current = nullptr;
+	const char* m_end = nullptr;
+
+	bool Refill();
+public:
+	InputReader(int _fd = 0) : m_fd(_fd), m_buffer(BUFFER_SIZE) {}
+	//false at the end of the input
+	bool ReadInt(int& _value);
+	bool ReadTurn(TurnInput& _turn);
+};
+
+bool InputReader::Refill()
+{
+	long size;
+	do
+	{
+		size = ReadDescriptor(m_fd, m_buffer.data(), BUFFER_SIZE);
+	} while (size < 0 && errno == EINTR);
+	if (size <= 0)
+	{
+		return false;
+	}
+	m_current = m_buffer.data();
+	m_end = m_current + size;
+	return true;
+}
+
+bool InputReader::ReadInt(int& _value)
+{
+	//skip the separators
+	while (true)
+	{
+		if (m_current == m_end && !Refill())
+		{
+			return false;
+		}
+		if (*m_current == '-' || (unsigned int)(*m_current - '0') < 10u)
+		{
+			break;
+		}
+		m_current++;
+	}
+	const bool isNegative = *m_current == '-';
+	m_current += isNegative;
+	//a number can be cut by the end of the buffer
+	int value = 0;
+	do
+	{
+		while (m_current < m_end && (unsigned int)(*m_current - '0') < 10u)
+		{
+			value = value * 10 + (*m_current++ - '0');
+		}
+	} while (m_current == m_end && Refill());
+	_value = isNegative ? -value : value;
+	return true;
+}
+
+bool InputReader::ReadTurn(TurnInput& _turn)
+{
+	for (PodInput& pod : _turn.pods)
+	{
+		if (!(ReadInt(pod.x) && ReadInt(pod.y) && ReadInt(pod.speedX) && ReadInt(pod.speedY) && ReadInt(pod.angle) && ReadInt(pod.nextCheckpointId)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//The output of a turn is formatted in one buffer and sent with a single write on Flush
+class OutputWriter
+{
+private:
+	int m_fd;
+	string m_buffer;
+public:
+	OutputWriter(int _fd = 1) : m_fd(_fd) { m_buffer.reserve(256); }
+	void Write(const char* _text) { m_buffer += _text; }
+	void Write(char _c) { m_buffer += _c; }
+	void Write(int _value);
+	void Flush();
+};
+
+void OutputWriter::Write(int _value)
+{
+	char digits[12];
+	int count = 0;
+	unsigned int magnitude = _value < 0 ? 0u - (unsigned int)_value : (unsigned int)_value;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (_value < 0)
+	{
+		m_buffer += '-';
+	}
+	while (count > 0)
+	{
+		m_buffer += digits[--count];
+	}
+}
+
+void OutputWriter::Flush()
+{
+	int written = 0;
+	while (written < (int)m_buffer.size())
+	{
+		const long size = WriteDescriptor(m_fd, m_buffer.data() + written, (int)m_buffer.size() - written);
+		if (size < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (size <= 0)
+		{
+			break;
+		}
+		written += size;
+	}
+	m_buffer.clear();
+}
+#pragma endregion InputOutput
 #pragma region PodClass
 
 class Pod
@@ -174,25 +608,27 @@ public:
 	inline int GetCheckpointId() { return m_nextCheckpointId; }
 	inline bool GetIsRacer() { return m_isRacer; }
 
-	void UpdateInfo(Checkpoint* _checkpoints);
+	void UpdateInfo(Checkpoint* _checkpoints, const PodInput& _input);
 	void UpdateAngleToCheckpoint(Checkpoint _cp);
 	void UpdateSteering();
 	void UpdateThrust(Pod* enemies, int _target, Checkpoint* _checkpoints, int _cpNb);
-	void GiveOutput();
+	void GiveOutput(OutputWriter& _output);
 	void ComputeShield(Pod* _myPods, Pod* _opponents, int _index);
 	static void GetFirstPod(Pod* _myPods);
 };
 
-void Pod::UpdateInfo(Checkpoint* _checkpoints)
+void Pod::UpdateInfo(Checkpoint* _checkpoints, const PodInput& _input)
 {
-	int checkpointId;
-	cin >> m_pos.m_x >> m_pos.m_y >> m_speed.m_x >> m_speed.m_y >> m_angle >> checkpointId;
-	if (checkpointId != m_nextCheckpointId)
+	m_pos.m_x = (float)_input.x;
+	m_pos.m_y = (float)_input.y;
+	m_speed.m_x = (float)_input.speedX;
+	m_speed.m_y = (float)_input.speedY;
+	m_angle = _input.angle;
+	if (_input.nextCheckpointId != m_nextCheckpointId)
 	{
-		m_nextCheckpointId = checkpointId;
+		m_nextCheckpointId = _input.nextCheckpointId;
 		m_checkpointsPassed++;
 	}
-	cin.ignore();
 	Vector2 checkpointPos((float)_checkpoints[m_nextCheckpointId].x, (float)_checkpoints[m_nextCheckpointId].y);
 	m_distanceToCheckpoint = Vector2::Distance(m_pos, checkpointPos);
 	m_destination.m_x = (float)_checkpoints[m_nextCheckpointId].x;
@@ -234,7 +670,7 @@ void Pod::UpdateAngleToCheckpoint(Checkpoint _cp)
 	RAD2DEG(a);
 	//a -= (float)m_angle;
 	m_angleToCheckpoint = (int)(abs(a));
-	cerr << "Angle = " << m_angleToCheckpoint << endl;
+	LOG_DEBUG("angle_to_checkpoint", "angle", m_angleToCheckpoint);
 	
 }
 
@@ -259,7 +695,7 @@ void Pod::ComputeShield(Pod* _myPods, Pod* _opponents, int _index)
 	else
 	{
 		m_shieldCooldown--;
-		cerr << "Shield cd = " << m_shieldCooldown << endl;
+		LOG_DEBUG("shield_cooldown", "turns", m_shieldCooldown);
 	}
 }
 
@@ -275,7 +711,7 @@ void Pod::UpdateSteering()
 		currentDirection = Vector2::Normalize(currentDirection);
 
 		Vector2 steering = (directionToCheckpoint - currentDirection);
-		steering = Vector2::Normalize(steering) * STEERING_FACTOR;
+		steering = Vector2::Normalize(steering) * Parameters::Get()[PARAMETER_STEERING_FACTOR];
 
 		m_destination.m_x += (int)steering.GetX();
 		m_destination.m_y += (int)steering.GetY();
@@ -308,7 +744,7 @@ void Pod::UpdateThrust(Pod* enemies, int _target, Checkpoint* _checkpoints, int
 					Vector2 playerToOpponent((float)(enemies[i].m_pos.m_x - m_pos.m_x), (float)(enemies[i].m_pos.m_y - m_pos.m_y));
 					int opponentDist = (int)(Vector2::Length(playerToOpponent));
 					playerToOpponent = Vector2::Normalize(playerToOpponent);
-					if (abs(Vector2::Dot(playerToCheckpoint, playerToOpponent)) > 0.8f && opponentDist < BOOSTINGSAFEZONE)
+					if (abs(Vector2::Dot(playerToCheckpoint, playerToOpponent)) > 0.8f && opponentDist < Parameters::Get()[PARAMETER_BOOSTINGSAFEZONE])
 					{
 						isBoostingSafe = false;
 					}
@@ -322,7 +758,7 @@ void Pod::UpdateThrust(Pod* enemies, int _target, Checkpoint* _checkpoints, int
 			}
 		}
 		//slow down depending on the distance when the checkpoint is close to prepare turning towards the next checkpoint
-		if (checkpointDist < BRAKING_DISTANCE)
+		if (checkpointDist < Parameters::Get()[PARAMETER_BRAKING_DISTANCE])
 		{
 			if (m_nextCheckpointId == _cpNb - 1)
 			{
@@ -339,62 +775,83 @@ void Pod::UpdateThrust(Pod* enemies, int _target, Checkpoint* _checkpoints, int
 	}
 	else if (abs(m_angleToCheckpoint) > 90)
 	{
-		cerr << "HARD TURN = " << m_angleToCheckpoint << endl;
+		LOG_DEBUG("hard_turn", "angle", m_angleToCheckpoint);
 		m_thrust = 0;
 	}
 	else
 	{
 		//slow down depending on the angle when the checkpoint is close to adjust my trajectory towards the checkpoint
 
-		cerr << "STEERING TURN" << endl;
+		LOG_DEBUG("steering_turn", "angle", m_angleToCheckpoint);
 		m_thrust = m_thrust * ((90 - abs(m_angleToCheckpoint)) / 90) - 10;
 		m_thrust = clamp(m_thrust, 10, THRUST_MAXIMUM);
 
 	}
 }
 
-void Pod::GiveOutput()
+void Pod::GiveOutput(OutputWriter& _output)
 {
+	_output.Write((int)m_destination.m_x);
+	_output.Write(' ');
+	_output.Write((int)m_destination.m_y);
+	_output.Write(' ');
 	if (m_isBoosting)
 	{
-		cout << m_destination.m_x << " " << m_destination.m_y << " " << "BOOST" << " BOOST" << endl;
+		_output.Write("BOOST BOOST");
 		m_isBoosting = false;
 	}
 	else if (m_isShielding)
 	{
-		cout << m_destination.m_x << " " << m_destination.m_y << " " << "SHIELD" << " SHIELD" << endl;
+		_output.Write("SHIELD SHIELD");
 		m_isShielding = false;
 	}
 	else
 	{
-		cout << m_destination.m_x << " " << m_destination.m_y << " " << m_thrust << " " << m_thrust << endl;
+		_output.Write(m_thrust);
+		_output.Write(' ');
+		_output.Write(m_thrust);
 	}
+	_output.Write('\n');
 }
 
 #pragma endregion PodClass
 
-int main()
+int main(int argc, char** argv)
 {
+	bool isListRequested = false;
+	if (!Parameters::Get().ParseArguments(argc, argv, isListRequested))
+	{
+		LOG_FLUSH();
+		return 1;
+	}
+	if (isListRequested)
+	{
+		Parameters::Get().Print();
+		return 0;
+	}
 	//new inputs from the gold league
-	int laps;
-	int checkpointCount;
-	cin >> laps >> checkpointCount;
-	cin.ignore();
+	InputReader input;
+	OutputWriter output;
+	int laps = 0;
+	int checkpointCount = 0;
+	input.ReadInt(laps);
+	input.ReadInt(checkpointCount);
 	Checkpoint _checkpoints[checkpointCount];
 	int target; //index of the first opponent pod in the race
 	for (int i = 0; i < checkpointCount; i++)
 	{
-		cin >> _checkpoints[i].x >> _checkpoints[i].y;
-		cin.ignore();
+		input.ReadInt(_checkpoints[i].x);
+		input.ReadInt(_checkpoints[i].y);
 	}
 	Pod myPods[2];
 	Pod opponentPods[2];
+	TurnInput turnInput;
 	// game loop
-	while (1)
+	while (input.ReadTurn(turnInput))
 	{
 		for (int i = 0; i < 2; i++)
 		{
-			myPods[i].UpdateInfo(_checkpoints);
+			myPods[i].UpdateInfo(_checkpoints, turnInput.pods[i]);
 
 		}
 		Pod::GetFirstPod(myPods);
@@ -409,7 +866,7 @@ int main()
 		}
 		for (int i = 0; i < 2; i++)
 		{
-			opponentPods[i].UpdateInfo(_checkpoints);
+			opponentPods[i].UpdateInfo(_checkpoints, turnInput.pods[2 + i]);
 		}
 
 		for (int i = 0; i < 2; i++)
@@ -418,7 +875,9 @@ int main()
 			myPods[i].ComputeShield(myPods, opponentPods, i);
 			myPods[i].UpdateSteering();
 			myPods[i].UpdateThrust(opponentPods, target, _checkpoints, checkpointCount);
-			myPods[i].GiveOutput();
+			myPods[i].GiveOutput(output);
 		}
+		output.Flush();
+		LOG_FLUSH();
 	}
 }
\ No newline at end of file
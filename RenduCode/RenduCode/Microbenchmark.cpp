@@ -0,0 +1,307 @@
+//Microbenchmark: nanoseconds per call of the building blocks of the simulation and of the solver, on fixed input sets.
+//Every kernel runs over its whole input set once per sample, the percentiles are over the samples.
+//"--save FILE" writes the results as a baseline, "--baseline FILE" adds the change against it to every line.
+//Build: make microbenchmark (see the Makefile), or g++ -std=c++17 -O2 -pthread Microbenchmark.cpp -o microbenchmark
+//Usage: microbenchmark [--filter TEXT] [--samples N] [--save FILE] [--baseline FILE]
+#define RENDUCODE_NO_MAIN
+#include "GoldToLegend.cpp"
+#include <map>
+
+#define MICROBENCHMARK_INPUTS 1024
+#define MICROBENCHMARK_SAMPLES 200
+#define MICROBENCHMARK_SEED 12345
+
+//keeps the compiler from removing a computation whose result is not used
+template<typename T>
+inline void KeepResult(const T& _value)
+{
+#ifdef __GNUC__
+	asm volatile("" : : "g"(&_value) : "memory");
+#else
+	static volatile char sink;
+	sink = *(const volatile char*)&_value;
+#endif
+}
+
+struct MicrobenchmarkResult
+{
+	string name;
+	double p50;
+	double p90;
+	double p99;
+	double minimum;
+	double mean;
+};
+
+class Microbenchmark
+{
+private:
+	int m_samples;
+	string m_filter;
+	FastRandom m_random{ MICROBENCHMARK_SEED };
+	Simulation m_simulation;
+	vector<MicrobenchmarkResult> m_results;
+
+	vector<Vector2> m_vectors;
+	vector<float> m_angles;
+	vector<RaceState> m_states; //pods moving around the track
+	vector<RaceState> m_contacts; //pods 0 and 1 touching
+	vector<Turn> m_turns;
+	vector<Solution> m_solutions;
+	vector<int> m_dirtyTurns; //first turn changed by a mutation, as drawn by Mutate
+
+public:
+	Microbenchmark(int _samples, const string& _filter);
+	void Run();
+	const vector<MicrobenchmarkResult>& GetResults() const { return m_results; }
+
+private:
+	float RandomFloat(float _minimum, float _maximum) { return _minimum + (_maximum - _minimum) * m_random.Next() / 32767.0f; }
+	RaceState RandomState();
+	template<typename Kernel>
+	void Measure(const char* _name, Kernel _kernel);
+};
+
+Microbenchmark::Microbenchmark(int _samples, const string& _filter)
+	: m_samples(_samples), m_filter(_filter)
+{
+	m_simulation.SetCheckpoints({ Vector2(12000, 2000), Vector2(3000, 7500), Vector2(13500, 7000), Vector2(6500, 1500) }, 3);
+	Solver solver(&m_simulation, MICROBENCHMARK_SEED);
+	for (int n = 0; n < MICROBENCHMARK_INPUTS; n++)
+	{
+		//a few zero vectors for the early return of Normalize
+		m_vectors.push_back(n % 64 == 0 ? Vector2(0.0f, 0.0f) : Vector2(RandomFloat(-16000.0f, 16000.0f), RandomFloat(-9000.0f, 9000.0f)));
+		m_angles.push_back((float)m_random.Range(-180, 181));
+		m_states.push_back(RandomState());
+
+		RaceState contact = RandomState();
+		const float direction = DEG2RAD(RandomFloat(0.0f, 360.0f));
+		contact.x[1] = contact.x[0] + 2.0f * POD_RADIUS * cos(direction);
+		contact.y[1] = contact.y[0] + 2.0f * POD_RADIUS * sin(direction);
+		m_contacts.push_back(contact);
+
+		Solution solution;
+		for (int t = 0; t < SIMULATION_TURNS; t++)
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				solver.Randomize(solution[t][i]);
+				solution[t][i].SetRotation(m_random.Range(-ROTATION_MAXIMUM, ROTATION_MAXIMUM + 1));
+			}
+		}
+		//the mutants of a generation are scored from the same state: SOLUTIONS_COUNT solutions share the cache of one state
+		m_simulation.ComputeSolutionSuffix(solution, m_states[n / SOLUTIONS_COUNT]);
+		m_solutions.push_back(solution);
+		m_turns.push_back(solution[0]);
+		m_dirtyTurns.push_back(m_random.Range(0, SIMULATION_TURNS));
+	}
+}
+
+RaceState Microbenchmark::RandomState()
+{
+	RaceState state;
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		state.x[i] = (float)(int)RandomFloat(0.0f, 16000.0f);
+		state.y[i] = (float)(int)RandomFloat(0.0f, 9000.0f);
+		state.speedX[i] = (float)(int)RandomFloat(-700.0f, 700.0f);
+		state.speedY[i] = (float)(int)RandomFloat(-700.0f, 700.0f);
+		state.angle[i] = m_random.Range(0, 360);
+		state.nextCheckpointId[i] = m_random.Range(0, 4);
+		state.totalCheckpointsPassed[i] = m_random.Range(0, 8);
+		state.shieldCooldown[i] = m_random.Range(0, 8) == 0 ? SHIELD_COOLDOWN : 0;
+		state.hasBoosted[i] = m_random.Range(0, 2) == 0;
+	}
+	return state;
+}
+
+//_kernel runs the operation on input n and returns its result
+template<typename Kernel>
+void Microbenchmark::Measure(const char* _name, Kernel _kernel)
+{
+	if (!m_filter.empty() && string(_name).find(m_filter) == string::npos)
+	{
+		return;
+	}
+	vector<double> samples;
+	for (int s = -1; s < m_samples; s++)
+	{
+		const auto start = chrono::steady_clock::now();
+		for (int n = 0; n < MICROBENCHMARK_INPUTS; n++)
+		{
+			KeepResult(_kernel(n));
+		}
+		const double nanoseconds = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / MICROBENCHMARK_INPUTS;
+		//the first pass only warms the caches up
+		if (s >= 0)
+		{
+			samples.push_back(nanoseconds);
+		}
+	}
+	sort(samples.begin(), samples.end());
+	MicrobenchmarkResult result;
+	result.name = _name;
+	result.p50 = samples[samples.size() / 2];
+	result.p90 = samples[samples.size() * 9 / 10];
+	result.p99 = samples[samples.size() * 99 / 100];
+	result.minimum = samples[0];
+	result.mean = 0.0;
+	for (double sample : samples)
+	{
+		result.mean += sample / samples.size();
+	}
+	m_results.push_back(result);
+}
+
+void Microbenchmark::Run()
+{
+	Measure("vector2_normalize", [this](int n) { return Vector2::Normalize(m_vectors[n]); });
+	Measure("vector2_rotate", [this](int n) { return Vector2::Rotate(m_vectors[n], m_angles[n]); });
+	Measure("time_to_collision", [this](int n) { return TimeToCollision(m_states[n], 0, 1 + n % 3); });
+	//the copy of the state is part of the measure of the kernels that change it
+	Measure("rebounce", [this](int n)
+		{
+			RaceState state = m_contacts[n];
+			Rebounce(state, 0, 1);
+			return state.speedX[0];
+		});
+	Measure("compute_whole_turn", [this](int n)
+		{
+			RaceState state = m_states[n];
+			m_simulation.ComputeWholeTurn(state, m_turns[n]);
+			return state.x[0];
+		});
+	Measure("opponent_move", [this](int n) { return m_simulation.m_opponentModel.GetMove(m_states[n], 2 + n % 2, m_simulation.m_checkpoints).GetBits(); });
+	Solver solver(&m_simulation, MICROBENCHMARK_SEED);
+	Measure("solver_mutate", [this, &solver](int n)
+		{
+			solver.Mutate(m_solutions[n]);
+			return m_solutions[n][0][0].GetBits();
+		});
+	Measure("solver_randomize", [this, &solver](int n)
+		{
+			Move& move = m_solutions[n][n % SIMULATION_TURNS][n % 2];
+			solver.Randomize(move, false);
+			return move.GetBits();
+		});
+	//a mutant is a copy of its parent, cache of states included
+	Measure("solution_copy", [this](int n) { return Solution(m_solutions[n]); });
+	//the mutants of a generation, with their cache valid up to the mutated turn, then all of them simulated from the first turn
+	for (int full = 0; full < 2; full++)
+	{
+		Measure(full == 0 ? "score_batch" : "score_batch_no_cache", [this, &solver, full](int n)
+			{
+				const int group = n % (MICROBENCHMARK_INPUTS / SOLUTIONS_COUNT);
+				Solution* mutants[SOLUTIONS_COUNT];
+				for (int s = 0; s < SOLUTIONS_COUNT; s++)
+				{
+					const int m = group * SOLUTIONS_COUNT + s;
+					mutants[s] = &m_solutions[m];
+					mutants[s]->firstDirtyTurn = full == 0 ? m_dirtyTurns[m] : 0;
+				}
+				solver.ComputeScoreBatch(mutants, SOLUTIONS_COUNT, m_states[group]);
+				return mutants[0]->score;
+			});
+	}
+	//the generations of a turn all search from the state the population was started on
+	solver.StartTurn(m_states[0]);
+	Measure("solver_generation", [this, &solver](int)
+		{
+			solver.RunGeneration(m_states[0]);
+			return solver.GetBest().score;
+		});
+}
+
+//baseline lines are the output lines: "microbenchmark name=NAME ns_p50=VALUE ..."
+map<string, double> LoadBaseline(const char* _path)
+{
+	map<string, double> baseline;
+	FILE* file = fopen(_path, "r");
+	if (file == nullptr)
+	{
+		return baseline;
+	}
+	char line[512];
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		char name[128];
+		double p50;
+		if (sscanf(line, "microbenchmark name=%127s ns_p50=%lf", name, &p50) == 2)
+		{
+			baseline[name] = p50;
+		}
+	}
+	fclose(file);
+	return baseline;
+}
+
+int main(int argc, char** argv)
+{
+	int samples = MICROBENCHMARK_SAMPLES;
+	string filter;
+	const char* savePath = nullptr;
+	const char* baselinePath = nullptr;
+	for (int a = 1; a < argc; a++)
+	{
+		const string argument = argv[a];
+		if (argument == "--samples" && a + 1 < argc)
+		{
+			samples = max(1, atoi(argv[++a]));
+		}
+		else if (argument == "--filter" && a + 1 < argc)
+		{
+			filter = argv[++a];
+		}
+		else if (argument == "--save" && a + 1 < argc)
+		{
+			savePath = argv[++a];
+		}
+		else if (argument == "--baseline" && a + 1 < argc)
+		{
+			baselinePath = argv[++a];
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--filter TEXT] [--samples N] [--save FILE] [--baseline FILE]\n", argv[0]);
+			return 2;
+		}
+	}
+	map<string, double> baseline;
+	if (baselinePath != nullptr)
+	{
+		baseline = LoadBaseline(baselinePath);
+		if (baseline.empty())
+		{
+			fprintf(stderr, "no result in the baseline %s\n", baselinePath);
+			return 1;
+		}
+	}
+
+	Microbenchmark benchmark(samples, filter);
+	benchmark.Run();
+	FILE* save = savePath != nullptr ? fopen(savePath, "w") : nullptr;
+	for (const MicrobenchmarkResult& result : benchmark.GetResults())
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "microbenchmark name=%s ns_p50=%.2f ns_p90=%.2f ns_p99=%.2f ns_min=%.2f ns_mean=%.2f",
+			result.name.c_str(), result.p50, result.p90, result.p99, result.minimum, result.mean);
+		if (save != nullptr)
+		{
+			fprintf(save, "%s\n", line);
+		}
+		const auto reference = baseline.find(result.name);
+		if (reference != baseline.end())
+		{
+			printf("%s baseline_p50=%.2f change=%+.1f%%\n", line, reference->second, 100.0 * (result.p50 / reference->second - 1.0));
+		}
+		else
+		{
+			printf("%s\n", line);
+		}
+	}
+	if (save != nullptr)
+	{
+		fclose(save);
+	}
+	return 0;
+}
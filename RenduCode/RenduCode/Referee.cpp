@@ -0,0 +1,546 @@
+//Headless referee: plays one race between two bot processes and prints the result.
+//The physics is the one of GoldToLegend, the bots talk through pipes with the protocol of the hosted game.
+//POSIX only. Build: g++ -std=c++17 -O2 -pthread Referee.cpp -o referee
+//Usage: referee [--seed N] [--laps N] [--single-pod] [--single-pod-player P] [--timeout-scale F] [--quiet] [--verbose] "<command of bot 0>" "<command of bot 1>"
+//--verbose writes the input of player 0 and the answers of both players to stderr every turn
+//--single-pod uses the protocol of the Wood to Silver leagues: one pod per player, next checkpoint position, distance and angle.
+//--single-pod-player only uses it for player P, so that bots of every league can race each other
+#define RENDUCODE_NO_MAIN
+#include "GoldToLegend.cpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#define TIMEOUT_TURNS 100 //turns a player has to pass its next checkpoint
+#define MAX_TURNS 1000
+#define MAP_WIDTH 16000
+#define MAP_HEIGHT 9000
+#define CHECKPOINT_MIN_COUNT 3
+#define CHECKPOINT_MAX_COUNT 8
+#define CHECKPOINT_MIN_DISTANCE 2500.0f //between 2 checkpoints of a track
+#define DEFAULT_LAPS 3
+//the processes are started before the first turn is timed, as on the hosted game
+#define BOT_STARTUP_TIME 100
+
+#pragma region TrackStruct
+struct Track
+{
+	int laps = DEFAULT_LAPS;
+	vector<Vector2> checkpoints;
+
+	static Track Random(unsigned int _seed, int _laps = DEFAULT_LAPS);
+};
+
+Track Track::Random(unsigned int _seed, int _laps)
+{
+	FastRandom random(_seed);
+	Track track;
+	track.laps = _laps;
+	const int count = random.Range(CHECKPOINT_MIN_COUNT, CHECKPOINT_MAX_COUNT + 1);
+	constexpr int margin = (int)CHECKPOINT_RADIUS;
+	while ((int)track.checkpoints.size() < count)
+	{
+		Vector2 checkpoint((float)random.Range(margin, MAP_WIDTH - margin), (float)random.Range(margin, MAP_HEIGHT - margin));
+		bool isFarEnough = true;
+		for (const Vector2& other : track.checkpoints)
+		{
+			isFarEnough = isFarEnough && Vector2::Distance(checkpoint, other) >= CHECKPOINT_MIN_DISTANCE;
+		}
+		if (isFarEnough)
+		{
+			track.checkpoints.push_back(checkpoint);
+		}
+	}
+	return track;
+}
+#pragma endregion TrackStruct
+
+#pragma region BotProcessClass
+//a bot running in a child process, its stdin and stdout are pipes
+class BotProcess
+{
+private:
+	pid_t m_pid = -1;
+	int m_input = -1; //write end of the bot's stdin
+	int m_output = -1; //read end of the bot's stdout
+	string m_pending; //output received but not consumed yet
+public:
+	~BotProcess() { Stop(); }
+	bool Start(const string& _command, bool _isQuiet);
+	bool Send(const string& _text);
+	//reads _count lines, false if they are not all received within _timeout milliseconds
+	bool ReadLines(int _count, double _timeout, vector<string>& _lines, double& _elapsed);
+	void Stop();
+};
+
+bool BotProcess::Start(const string& _command, bool _isQuiet)
+{
+	int toBot[2];
+	int fromBot[2];
+	//close on exec: the bots of the other games forked by the tournament must not keep these pipes open, or the end of a bot is never seen
+	if (pipe2(toBot, O_CLOEXEC) != 0 || pipe2(fromBot, O_CLOEXEC) != 0)
+	{
+		return false;
+	}
+	//nothing is allocated between fork and exec, the tournament forks from several threads
+	const string shellCommand = "exec " + _command;
+	m_pid = fork();
+	if (m_pid < 0)
+	{
+		return false;
+	}
+	if (m_pid == 0)
+	{
+		//own process group, so that Stop also kills what the shell started
+		setpgid(0, 0);
+		dup2(toBot[0], 0);
+		dup2(fromBot[1], 1);
+		if (_isQuiet)
+		{
+			const int devNull = open("/dev/null", O_WRONLY);
+			dup2(devNull, 2);
+		}
+		close(toBot[0]);
+		close(toBot[1]);
+		close(fromBot[0]);
+		close(fromBot[1]);
+		execl("/bin/sh", "sh", "-c", shellCommand.c_str(), (char*)nullptr);
+		_exit(127);
+	}
+	//also set by the parent: Stop can run before the child has set its group, and kill would miss it
+	setpgid(m_pid, m_pid);
+	close(toBot[0]);
+	close(fromBot[1]);
+	m_input = toBot[1];
+	m_output = fromBot[0];
+	return true;
+}
+
+bool BotProcess::Send(const string& _text)
+{
+	int written = 0;
+	while (written < (int)_text.size())
+	{
+		const long size = WriteDescriptor(m_input, _text.data() + written, (int)_text.size() - written);
+		if (size < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (size <= 0)
+		{
+			return false;
+		}
+		written += size;
+	}
+	return true;
+}
+
+bool BotProcess::ReadLines(int _count, double _timeout, vector<string>& _lines, double& _elapsed)
+{
+	const auto start = chrono::steady_clock::now();
+	_lines.clear();
+	char buffer[4096];
+	while (true)
+	{
+		size_t end;
+		while ((int)_lines.size() < _count && (end = m_pending.find('\n')) != string::npos)
+		{
+			_lines.push_back(m_pending.substr(0, end));
+			m_pending.erase(0, end + 1);
+		}
+		_elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		if ((int)_lines.size() == _count)
+		{
+			return _elapsed <= _timeout;
+		}
+		const int remaining = (int)ceil(_timeout - _elapsed);
+		if (remaining <= 0)
+		{
+			return false;
+		}
+		pollfd request = { m_output, POLLIN, 0 };
+		const int ready = poll(&request, 1, remaining);
+		if (ready < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (ready <= 0)
+		{
+			continue;
+		}
+		const long size = ReadDescriptor(m_output, buffer, sizeof(buffer));
+		if (size <= 0)
+		{
+			//the bot exited or closed its output
+			return false;
+		}
+		m_pending.append(buffer, size);
+	}
+}
+
+void BotProcess::Stop()
+{
+	if (m_pid <= 0)
+	{
+		return;
+	}
+	close(m_input);
+	close(m_output);
+	//the bots loop on their input forever
+	kill(-m_pid, SIGKILL);
+	waitpid(m_pid, nullptr, 0);
+	m_pid = -1;
+}
+#pragma endregion BotProcessClass
+
+#pragma region RefereeClass
+struct MatchResult
+{
+	int winner = -1; //-1 for a draw
+	int turns = 0;
+	string reason;
+	double maxResponseTime[2] = {};
+	double totalResponseTime[2] = {};
+};
+
+//Player p owns the pods 2p and 2p + 1 of the race state. With one pod per player the second pods are parked far from the track
+class Referee
+{
+private:
+	Track m_track;
+	Simulation m_simulation;
+	RaceState m_state;
+	bool m_isSinglePod[2];
+	double m_timeoutScale;
+	int m_turnsLeft[2]; //turns before each player times out
+	BotProcess m_bots[2];
+public:
+	Referee(const Track& _track, const bool _isSinglePod[2], double _timeoutScale);
+	MatchResult Play(const string _commands[2], bool _isQuiet, bool _isVerbose);
+
+private:
+	int GetPodsPerPlayer(int _player) const { return m_isSinglePod[_player] ? 1 : 2; }
+	void InitState();
+	string GetInitInput() const;
+	string GetTurnInput(int _player, bool _isFirstTurn) const;
+	bool ApplyCommand(int _pod, const string& _line, bool _isFirstTurn);
+	void FinishTurn();
+};
+
+Referee::Referee(const Track& _track, const bool _isSinglePod[2], double _timeoutScale)
+	: m_track(_track), m_isSinglePod{ _isSinglePod[0], _isSinglePod[1] }, m_timeoutScale(_timeoutScale)
+{
+	m_simulation.SetCheckpoints(m_track.checkpoints, m_track.laps);
+	InitState();
+}
+
+//the pods start on the first checkpoint, in a line perpendicular to the first segment
+void Referee::InitState()
+{
+	const Vector2& start = m_track.checkpoints[0];
+	const Vector2 forward = Vector2::Normalize(m_track.checkpoints[1] - start);
+	const Vector2 side(-forward.GetY(), forward.GetX());
+	const float offsets[POD_COUNT] = { 500.0f, 1500.0f, -500.0f, -1500.0f };
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		const bool isParked = m_isSinglePod[i / 2] && i % 2 == 1;
+		m_state.x[i] = isParked ? -100000.0f * i : round(start.GetX() + side.GetX() * offsets[i]);
+		m_state.y[i] = isParked ? -100000.0f : round(start.GetY() + side.GetY() * offsets[i]);
+		m_state.speedX[i] = 0.0f;
+		m_state.speedY[i] = 0.0f;
+		m_state.angle[i] = -1;
+		m_state.nextCheckpointId[i] = 1;
+		m_state.totalCheckpointsPassed[i] = 0;
+		m_state.shieldCooldown[i] = 0;
+		m_state.hasBoosted[i] = false;
+	}
+	m_turnsLeft[0] = TIMEOUT_TURNS;
+	m_turnsLeft[1] = TIMEOUT_TURNS;
+}
+
+string Referee::GetInitInput() const
+{
+	string input = to_string(m_track.laps) + "\n" + to_string(m_track.checkpoints.size()) + "\n";
+	for (const Vector2& checkpoint : m_track.checkpoints)
+	{
+		input += to_string((int)checkpoint.GetX()) + " " + to_string((int)checkpoint.GetY()) + "\n";
+	}
+	return input;
+}
+
+string Referee::GetTurnInput(int _player, bool _isFirstTurn) const
+{
+	string input;
+	auto podLine = [this](int _i)
+	{
+		return to_string((int)m_state.x[_i]) + " " + to_string((int)m_state.y[_i]) + " " + to_string((int)m_state.speedX[_i]) + " " + to_string((int)m_state.speedY[_i])
+			+ " " + to_string(m_state.angle[_i]) + " " + to_string(m_state.nextCheckpointId[_i]) + "\n";
+	};
+	const int opponent = 1 - _player;
+	if (!m_isSinglePod[_player])
+	{
+		for (int i : { 2 * _player, 2 * _player + 1, 2 * opponent, 2 * opponent + 1 })
+		{
+			input += podLine(i);
+		}
+		return input;
+	}
+	const int pod = 2 * _player;
+	Vector2 checkpoint = m_simulation.GetCheckpoints()[m_state.nextCheckpointId[pod]];
+	const Vector2 toCheckpoint = checkpoint - m_state.GetPosition(pod);
+	const int checkpointAngle = Vector2::GetClosestAngle(Vector2::Normalize(toCheckpoint));
+	//angle from the pod direction to the checkpoint, the pod faces the checkpoint before the first turn
+	const int relativeAngle = _isFirstTurn ? 0 : (checkpointAngle - m_state.angle[pod] + 540) % 360 - 180;
+	input += to_string((int)m_state.x[pod]) + " " + to_string((int)m_state.y[pod]) + " " + to_string((int)checkpoint.GetX()) + " " + to_string((int)checkpoint.GetY())
+		+ " " + to_string((int)Vector2::Length(toCheckpoint)) + " " + to_string(relativeAngle) + "\n";
+	input += to_string((int)m_state.x[2 * opponent]) + " " + to_string((int)m_state.y[2 * opponent]) + "\n";
+	return input;
+}
+
+//rotation and thrust of pod _pod from a line "x y thrust|BOOST|SHIELD [message]", false if the line is invalid
+bool Referee::ApplyCommand(int _pod, const string& _line, bool _isFirstTurn)
+{
+	char thrustText[32] = {};
+	int targetX, targetY;
+	if (sscanf(_line.c_str(), "%d %d %31s", &targetX, &targetY, thrustText) != 3)
+	{
+		return false;
+	}
+	const bool useShield = strcmp(thrustText, "SHIELD") == 0;
+	const bool useBoost = strcmp(thrustText, "BOOST") == 0;
+	int thrust = THRUST_MAXIMUM;
+	if (!useShield && !useBoost)
+	{
+		char* end;
+		const long value = strtol(thrustText, &end, 10);
+		if (*end != '\0' || value < 0 || value > THRUST_MAXIMUM)
+		{
+			return false;
+		}
+		thrust = (int)value;
+	}
+
+	//the pod can turn by ROTATION_MAXIMUM degrees, and freely on the first turn
+	const Vector2 toTarget((float)targetX - m_state.x[_pod], (float)targetY - m_state.y[_pod]);
+	if (Vector2::Length(toTarget) > 0.0f)
+	{
+		const int targetAngle = Vector2::GetClosestAngle(Vector2::Normalize(toTarget));
+		if (_isFirstTurn)
+		{
+			m_state.angle[_pod] = targetAngle;
+		}
+		else
+		{
+			const int rotation = clamp((targetAngle - m_state.angle[_pod] + 540) % 360 - 180, -ROTATION_MAXIMUM, ROTATION_MAXIMUM);
+			m_state.angle[_pod] = (m_state.angle[_pod] + rotation + 360) % 360;
+		}
+	}
+	else if (_isFirstTurn)
+	{
+		m_state.angle[_pod] = 0;
+	}
+
+	ManageShield(useShield, m_state, _pod);
+	if (m_state.shieldCooldown[_pod] > 0)
+	{
+		return true;
+	}
+	if (useBoost && !m_state.hasBoosted[_pod])
+	{
+		thrust = THRUST_BOOST;
+		m_state.hasBoosted[_pod] = true;
+	}
+	const Vector2& direction = Vector2::FromAngle(m_state.angle[_pod]);
+	m_state.speedX[_pod] += (float)thrust * direction.GetX();
+	m_state.speedY[_pod] += (float)thrust * direction.GetY();
+	return true;
+}
+
+//the hosted game truncates the speeds where the solver rounds them
+void Referee::FinishTurn()
+{
+	for (int i = 0; i < POD_COUNT; i++)
+	{
+		m_state.speedX[i] = trunc(m_state.speedX[i]);
+		m_state.speedY[i] = trunc(m_state.speedY[i]);
+		m_state.x[i] = round(m_state.x[i]);
+		m_state.y[i] = round(m_state.y[i]);
+	}
+}
+
+MatchResult Referee::Play(const string _commands[2], bool _isQuiet, bool _isVerbose)
+{
+	MatchResult result;
+	for (int p = 0; p < 2; p++)
+	{
+		if (!m_bots[p].Start(_commands[p], _isQuiet) || (!m_isSinglePod[p] && !m_bots[p].Send(GetInitInput())))
+		{
+			result.winner = 1 - p;
+			result.reason = "crash";
+			return result;
+		}
+	}
+
+	this_thread::sleep_for(chrono::milliseconds(BOT_STARTUP_TIME));
+
+	vector<string> lines;
+	for (int turn = 0; turn < MAX_TURNS; turn++)
+	{
+		result.turns = turn + 1;
+		const bool isFirstTurn = turn == 0;
+		//both bots answer from the same state before anything moves
+		int failedPlayers = 0;
+		vector<string> commands[2];
+		for (int p = 0; p < 2; p++)
+		{
+			const double timeout = (isFirstTurn ? TIMEOUT_FIRST_TURN : TIMEOUT) * m_timeoutScale;
+			double elapsed = 0.0;
+			const string input = GetTurnInput(p, isFirstTurn);
+			const bool hasAnswered = m_bots[p].Send(input) && m_bots[p].ReadLines(GetPodsPerPlayer(p), timeout, lines, elapsed);
+			if (_isVerbose)
+			{
+				fprintf(stderr, "%s", p == 0 ? ("turn " + to_string(turn) + "\n" + input).c_str() : "");
+				for (const string& line : lines)
+				{
+					fprintf(stderr, "player %d: %s (%.3f ms)\n", p, line.c_str(), elapsed);
+				}
+			}
+			result.maxResponseTime[p] = max(result.maxResponseTime[p], elapsed);
+			result.totalResponseTime[p] += elapsed;
+			if (!hasAnswered)
+			{
+				failedPlayers |= 1 << p;
+				result.reason = "timeout";
+			}
+			commands[p] = lines;
+		}
+		for (int p = 0; p < 2 && failedPlayers == 0; p++)
+		{
+			for (int k = 0; k < GetPodsPerPlayer(p); k++)
+			{
+				if (!ApplyCommand(2 * p + k, commands[p][k], isFirstTurn))
+				{
+					failedPlayers |= 1 << p;
+					result.reason = "invalid_output";
+				}
+			}
+		}
+		if (failedPlayers != 0)
+		{
+			result.winner = failedPlayers == 3 ? -1 : (failedPlayers == 1 ? 1 : 0);
+			return result;
+		}
+
+		int passedBefore[POD_COUNT];
+		memcpy(passedBefore, m_state.totalCheckpointsPassed, sizeof(passedBefore));
+		m_simulation.MovePods(m_state);
+		FinishTurn();
+
+		int finishedPlayers = 0;
+		int timedOutPlayers = 0;
+		for (int p = 0; p < 2; p++)
+		{
+			bool hasPassed = false;
+			for (int k = 0; k < GetPodsPerPlayer(p); k++)
+			{
+				const int i = 2 * p + k;
+				hasPassed = hasPassed || m_state.totalCheckpointsPassed[i] > passedBefore[i];
+				if (m_state.totalCheckpointsPassed[i] >= m_simulation.GetMaxCheckpoints())
+				{
+					finishedPlayers |= 1 << p;
+				}
+			}
+			m_turnsLeft[p] = hasPassed ? TIMEOUT_TURNS : m_turnsLeft[p] - 1;
+			if (m_turnsLeft[p] <= 0)
+			{
+				timedOutPlayers |= 1 << p;
+			}
+		}
+		//the finish time inside the turn is not known: 2 players finishing on the same turn is a draw
+		if (finishedPlayers != 0)
+		{
+			result.winner = finishedPlayers == 3 ? -1 : (finishedPlayers == 1 ? 0 : 1);
+			result.reason = "finish";
+			return result;
+		}
+		if (timedOutPlayers != 0)
+		{
+			result.winner = timedOutPlayers == 3 ? -1 : (timedOutPlayers == 1 ? 1 : 0);
+			result.reason = "checkpoint_timeout";
+			return result;
+		}
+	}
+	result.reason = "max_turns";
+	return result;
+}
+#pragma endregion RefereeClass
+
+//the tournament includes this file to reuse the referee, it defines REFEREE_NO_MAIN
+#ifndef REFEREE_NO_MAIN
+int main(int argc, char** argv)
+{
+	unsigned int seed = (unsigned int)chrono::steady_clock::now().time_since_epoch().count();
+	int laps = DEFAULT_LAPS;
+	bool isSinglePod[2] = { false, false };
+	bool isQuiet = false;
+	bool isVerbose = false;
+	double timeoutScale = 1.0;
+	vector<string> commands;
+	for (int a = 1; a < argc; a++)
+	{
+		const string argument = argv[a];
+		if (argument == "--seed" && a + 1 < argc)
+		{
+			seed = (unsigned int)strtoul(argv[++a], nullptr, 10);
+		}
+		else if (argument == "--laps" && a + 1 < argc)
+		{
+			laps = atoi(argv[++a]);
+		}
+		else if (argument == "--timeout-scale" && a + 1 < argc)
+		{
+			timeoutScale = atof(argv[++a]);
+		}
+		else if (argument == "--single-pod")
+		{
+			isSinglePod[0] = true;
+			isSinglePod[1] = true;
+		}
+		else if (argument == "--single-pod-player" && a + 1 < argc)
+		{
+			isSinglePod[atoi(argv[++a]) != 0] = true;
+		}
+		else if (argument == "--quiet")
+		{
+			isQuiet = true;
+		}
+		else if (argument == "--verbose")
+		{
+			isVerbose = true;
+		}
+		else
+		{
+			commands.push_back(argument);
+		}
+	}
+	if (commands.size() != 2)
+	{
+		fprintf(stderr, "usage: %s [--seed N] [--laps N] [--single-pod] [--single-pod-player P] [--timeout-scale F] [--quiet] [--verbose] \"<bot 0>\" \"<bot 1>\"\n", argv[0]);
+		return 2;
+	}
+	//a bot that exits must not kill the referee
+	signal(SIGPIPE, SIG_IGN);
+
+	const Track track = Track::Random(seed, laps);
+	Referee referee(track, isSinglePod, timeoutScale);
+	const MatchResult result = referee.Play(commands.data(), isQuiet, isVerbose);
+	printf("result seed=%u winner=%d turns=%d reason=%s checkpoints=%d\n", seed, result.winner, result.turns, result.reason.c_str(), (int)track.checkpoints.size());
+	for (int p = 0; p < 2; p++)
+	{
+		printf("player index=%d max_ms=%.3f average_ms=%.3f\n", p, result.maxResponseTime[p], result.totalResponseTime[p] / max(1, result.turns));
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,116 @@
+//Replayer: searches the turns of a trace recorded with "GoldToLegend --record FILE" again, with the recorded seed, parameters and generations.
+//Every turn is compared with the recorded decision, so a turn of a real game can be reproduced, debugged and profiled.
+//Build: g++ -std=c++17 -O2 -pthread Replayer.cpp -o replayer
+//Usage: replayer [--turn T] TRACE
+//One line per turn with its generations, the replay time and whether the decision matches. With --turn T the replay stops after turn T
+#define RENDUCODE_NO_MAIN
+#include "GoldToLegend.cpp"
+
+//total of the generations run by all of the islands
+int CountGenerations(const vector<int>& _generationLog, int _islandCount)
+{
+	int generations = 0;
+	for (size_t run = 0; run + _islandCount < _generationLog.size(); run += _islandCount + 1)
+	{
+		for (int i = 0; i < _islandCount; i++)
+		{
+			generations += _generationLog[run] * _generationLog[run + 1 + i];
+		}
+	}
+	return generations;
+}
+
+int main(int argc, char** argv)
+{
+	int lastTurn = -1;
+	const char* path = nullptr;
+	for (int a = 1; a < argc; a++)
+	{
+		if (strcmp(argv[a], "--turn") == 0 && a + 1 < argc)
+		{
+			lastTurn = atoi(argv[++a]);
+		}
+		else if (path == nullptr && argv[a][0] != '-')
+		{
+			path = argv[a];
+		}
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", argv[a]);
+			return 2;
+		}
+	}
+	if (path == nullptr)
+	{
+		fprintf(stderr, "usage: %s [--turn T] TRACE\n", argv[0]);
+		return 2;
+	}
+
+	TraceReader reader;
+	TraceHeader header;
+	if (!reader.Open(path) || !reader.ReadHeader(header))
+	{
+		fprintf(stderr, "%s is not a trace\n", path);
+		return 1;
+	}
+	//the genome and the population sizes change the random draws of the search
+	if (header.simulationTurns != SIMULATION_TURNS || header.solutionsCount != SOLUTIONS_COUNT || header.parameters.size() != PARAMETER_COUNT
+		|| header.engine == ENGINE_COUNT)
+	{
+		fprintf(stderr, "trace recorded with SIMULATION_TURNS=%d SOLUTIONS_COUNT=%d, %d parameters and engine %d, build the replayer with the same\n",
+			header.simulationTurns, header.solutionsCount, (int)header.parameters.size(), (int)header.engine);
+		return 1;
+	}
+	for (int i = 0; i < PARAMETER_COUNT; i++)
+	{
+		Parameters::Get().Set(PARAMETER_DEFINITIONS[i].name, header.parameters[i]);
+	}
+
+	Simulation simulation;
+	simulation.SetCheckpoints(header.checkpoints, header.laps);
+	Vector2 firstCheckpoint = header.checkpoints[1];
+	//the generation log fixes the work of every island, one thread gives the same result
+	IslandSolver solver{ &simulation, 1, header.islandCount, header.seed, header.engine };
+	vector<Pod> pods(POD_COUNT);
+	RaceState predictedState;
+	RaceState previousState;
+	TraceTurn turn;
+	int step = 0;
+	int mismatches = 0;
+	while ((lastTurn < 0 || step <= lastTurn) && reader.ReadTurn(turn))
+	{
+		UpdatePods(pods, turn.input, step == 0, firstCheckpoint);
+		RaceState state;
+		state.Load(pods);
+
+		const auto start = chrono::steady_clock::now();
+		PonderOutcome ponderOutcome = PONDER_NONE;
+		if (turn.ponderOutcome != PONDER_NONE)
+		{
+			ponderOutcome = solver.ReplayPondering(predictedState, state, turn.ponderLog);
+		}
+#if OPPONENT_MODEL
+		if (step > 0)
+		{
+			simulation.ObserveOpponents(previousState, pods);
+			state.Load(pods);
+		}
+		previousState = state;
+#endif
+		const Solution& solution = solver.Replay(state, turn.generationLog);
+		const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+		const bool isMatching = ponderOutcome == turn.ponderOutcome && solution.score == turn.score
+			&& solution[0][0].GetBits() == turn.moves[0] && solution[0][1].GetBits() == turn.moves[1];
+		mismatches += isMatching ? 0 : 1;
+		printf("turn step=%d generations=%d ponder=%d ponder_generations=%d score=%d match=%d replay_ms=%.3f recorded_slack_ms=%.3f recorded_generation_us=%.3f\n",
+			step, CountGenerations(turn.generationLog, header.islandCount), (int)turn.ponderOutcome, CountGenerations(turn.ponderLog, header.islandCount),
+			turn.score, isMatching ? 1 : 0, milliseconds, turn.slack / 1000.0, turn.generationCost / 1000.0);
+
+		UpdateShieldAndBoostForNextTurn(solution, pods);
+		predictedState = solution.states[0];
+		++step;
+	}
+	printf("replay turns=%d mismatches=%d islands=%d recorded_threads=%d\n", step, mismatches, header.islandCount, header.threadCount);
+	return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+//Tournament: round robin between bots on random tracks, several games at a time, with Elo ratings.
+//Every track is played twice by a pair of bots, once from each side.
+//The ratings are the maximum likelihood of the Bradley-Terry model, their 95% interval comes from bootstrap resampling of the games.
+//POSIX only. Build: g++ -std=c++17 -O2 -pthread Tournament.cpp -o tournament
+//Usage: tournament [--games N] [--jobs J] [--seed S] [--laps N] [--timeout-scale F] --bot NAME "COMMAND" --single-pod-bot NAME "COMMAND" ...
+//--single-pod-bot is for the bots of the Wood to Silver leagues, see Referee.cpp
+#define REFEREE_NO_MAIN
+#include "Referee.cpp"
+
+#define ELO_ITERATIONS 200
+#define ELO_BOOTSTRAP_SAMPLES 200
+#define PROGRESS_GAMES 10 //a progress line is written on stderr every PROGRESS_GAMES games
+
+struct TournamentBot
+{
+	string name;
+	string command;
+	bool isSinglePod;
+};
+
+struct GameRecord
+{
+	int bots[2]; //the bot playing each side
+	MatchResult result;
+};
+
+class Tournament
+{
+private:
+	vector<TournamentBot> m_bots;
+	vector<pair<int, int>> m_pairs;
+	unsigned int m_seed;
+	int m_laps;
+	double m_timeoutScale;
+	vector<GameRecord> m_games;
+	atomic<int> m_nextGame{ 0 };
+	atomic<int> m_finishedGames{ 0 };
+public:
+	Tournament(const vector<TournamentBot>& _bots, unsigned int _seed, int _laps, double _timeoutScale);
+	void Run(int _gameCount, int _jobs);
+	void Report(double _seconds, int _jobs) const;
+
+private:
+	void WorkerLoop();
+	GameRecord PlayGame(int _game) const;
+	vector<double> ComputeElo(const vector<int>& _games) const;
+};
+
+Tournament::Tournament(const vector<TournamentBot>& _bots, unsigned int _seed, int _laps, double _timeoutScale)
+	: m_bots(_bots), m_seed(_seed), m_laps(_laps), m_timeoutScale(_timeoutScale)
+{
+	for (int a = 0; a < (int)m_bots.size(); a++)
+	{
+		for (int b = a + 1; b < (int)m_bots.size(); b++)
+		{
+			m_pairs.emplace_back(a, b);
+		}
+	}
+}
+
+void Tournament::Run(int _gameCount, int _jobs)
+{
+	m_games.resize(_gameCount);
+	vector<thread> workers;
+	for (int j = 0; j < _jobs; j++)
+	{
+		workers.emplace_back(&Tournament::WorkerLoop, this);
+	}
+	for (thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void Tournament::WorkerLoop()
+{
+	const int gameCount = (int)m_games.size();
+	for (int game = m_nextGame++; game < gameCount; game = m_nextGame++)
+	{
+		m_games[game] = PlayGame(game);
+		const int finished = ++m_finishedGames;
+		if (finished % PROGRESS_GAMES == 0 || finished == gameCount)
+		{
+			fprintf(stderr, "progress games=%d/%d\n", finished, gameCount);
+		}
+	}
+}
+
+//games 2k and 2k + 1 share the track of seed m_seed + k, with the sides swapped
+GameRecord Tournament::PlayGame(int _game) const
+{
+	const pair<int, int>& players = m_pairs[(_game / 2) % m_pairs.size()];
+	const bool isSwapped = _game % 2 == 1;
+	GameRecord record;
+	record.bots[0] = isSwapped ? players.second : players.first;
+	record.bots[1] = isSwapped ? players.first : players.second;
+
+	const Track track = Track::Random(m_seed + _game / 2, m_laps);
+	const bool isSinglePod[2] = { m_bots[record.bots[0]].isSinglePod, m_bots[record.bots[1]].isSinglePod };
+	const string commands[2] = { m_bots[record.bots[0]].command, m_bots[record.bots[1]].command };
+	Referee referee(track, isSinglePod, m_timeoutScale);
+	record.result = referee.Play(commands, true, false);
+	return record;
+}
+
+//Bradley-Terry ratings of the games _games (indices in m_games, repeated by the bootstrap), with the minorization-maximization iterations.
+//Each pair of bots gets one virtual draw so that a bot that never won keeps a finite rating. Ratings are in Elo points with a mean of 0
+vector<double> Tournament::ComputeElo(const vector<int>& _games) const
+{
+	const int botCount = (int)m_bots.size();
+	vector<double> scores(botCount * botCount, 0.0);
+	vector<double> games(botCount * botCount, 0.0);
+	for (const pair<int, int>& players : m_pairs)
+	{
+		scores[players.first * botCount + players.second] += 0.5;
+		scores[players.second * botCount + players.first] += 0.5;
+		games[players.first * botCount + players.second] += 1.0;
+		games[players.second * botCount + players.first] += 1.0;
+	}
+	for (int g : _games)
+	{
+		const GameRecord& record = m_games[g];
+		const int a = record.bots[0];
+		const int b = record.bots[1];
+		const double scoreA = record.result.winner == -1 ? 0.5 : (record.result.winner == 0 ? 1.0 : 0.0);
+		scores[a * botCount + b] += scoreA;
+		scores[b * botCount + a] += 1.0 - scoreA;
+		games[a * botCount + b] += 1.0;
+		games[b * botCount + a] += 1.0;
+	}
+
+	vector<double> strengths(botCount, 1.0);
+	for (int iteration = 0; iteration < ELO_ITERATIONS; iteration++)
+	{
+		for (int i = 0; i < botCount; i++)
+		{
+			double totalScore = 0.0;
+			double denominator = 0.0;
+			for (int j = 0; j < botCount; j++)
+			{
+				if (j != i)
+				{
+					totalScore += scores[i * botCount + j];
+					denominator += games[i * botCount + j] / (strengths[i] + strengths[j]);
+				}
+			}
+			strengths[i] = totalScore / denominator;
+		}
+	}
+	vector<double> elo(botCount);
+	double mean = 0.0;
+	for (int i = 0; i < botCount; i++)
+	{
+		elo[i] = 400.0 * log10(strengths[i]);
+		mean += elo[i] / botCount;
+	}
+	for (double& rating : elo)
+	{
+		rating -= mean;
+	}
+	return elo;
+}
+
+void Tournament::Report(double _seconds, int _jobs) const
+{
+	const int botCount = (int)m_bots.size();
+	const int gameCount = (int)m_games.size();
+	vector<int> allGames(gameCount);
+	for (int g = 0; g < gameCount; g++)
+	{
+		allGames[g] = g;
+	}
+	const vector<double> elo = ComputeElo(allGames);
+
+	//confidence interval: ratings of tournaments made of games drawn with replacement
+	FastRandom random(m_seed);
+	vector<vector<double>> samples(botCount);
+	vector<int> sample(gameCount);
+	for (int s = 0; s < ELO_BOOTSTRAP_SAMPLES; s++)
+	{
+		for (int g = 0; g < gameCount; g++)
+		{
+			//2 draws of 15 bits, enough for any number of games
+			sample[g] = (int)((((unsigned int)random.Next() << 15) | (unsigned int)random.Next()) % (unsigned int)gameCount);
+		}
+		const vector<double> sampleElo = ComputeElo(sample);
+		for (int i = 0; i < botCount; i++)
+		{
+			samples[i].push_back(sampleElo[i]);
+		}
+	}
+
+	printf("tournament games=%d jobs=%d seconds=%.1f games_per_hour=%.1f\n", gameCount, _jobs, _seconds, gameCount * 3600.0 / max(_seconds, 0.001));
+	vector<int> ranking(botCount);
+	for (int i = 0; i < botCount; i++)
+	{
+		ranking[i] = i;
+	}
+	sort(ranking.begin(), ranking.end(), [&elo](int a, int b) { return elo[a] > elo[b]; });
+	for (int i : ranking)
+	{
+		int games = 0;
+		int wins = 0;
+		int draws = 0;
+		int failures = 0; //games lost by timeout, invalid output or crash
+		int finishes = 0;
+		int finishTurns = 0;
+		for (const GameRecord& record : m_games)
+		{
+			for (int side = 0; side < 2; side++)
+			{
+				if (record.bots[side] != i)
+				{
+					continue;
+				}
+				games++;
+				const MatchResult& result = record.result;
+				draws += result.winner == -1;
+				if (result.winner == side)
+				{
+					wins++;
+					if (result.reason == "finish")
+					{
+						finishes++;
+						finishTurns += result.turns;
+					}
+				}
+				else if (result.winner == 1 - side && result.reason != "finish" && result.reason != "checkpoint_timeout")
+				{
+					failures++;
+				}
+			}
+		}
+		sort(samples[i].begin(), samples[i].end());
+		const double low = samples[i][(int)(0.025 * (ELO_BOOTSTRAP_SAMPLES - 1))];
+		const double high = samples[i][(int)(0.975 * (ELO_BOOTSTRAP_SAMPLES - 1))];
+		printf("bot name=%s elo=%.1f elo_low=%.1f elo_high=%.1f games=%d wins=%d draws=%d win_rate=%.3f average_finish_turn=%.1f failures=%d\n",
+			m_bots[i].name.c_str(), elo[i], low, high, games, wins, draws, games > 0 ? (wins + 0.5 * draws) / games : 0.0,
+			finishes > 0 ? (double)finishTurns / finishes : 0.0, failures);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int gameCount = 100;
+	//a game runs 2 bots, and a bot can keep a core busy while its opponent thinks
+	int jobs = max(1, (int)thread::hardware_concurrency() / 2);
+	unsigned int seed = 1;
+	int laps = DEFAULT_LAPS;
+	double timeoutScale = 1.0;
+	vector<TournamentBot> bots;
+	for (int a = 1; a < argc; a++)
+	{
+		const string argument = argv[a];
+		if (argument == "--games" && a + 1 < argc)
+		{
+			gameCount = atoi(argv[++a]);
+		}
+		else if (argument == "--jobs" && a + 1 < argc)
+		{
+			jobs = max(1, atoi(argv[++a]));
+		}
+		else if (argument == "--seed" && a + 1 < argc)
+		{
+			seed = (unsigned int)strtoul(argv[++a], nullptr, 10);
+		}
+		else if (argument == "--laps" && a + 1 < argc)
+		{
+			laps = atoi(argv[++a]);
+		}
+		else if (argument == "--timeout-scale" && a + 1 < argc)
+		{
+			timeoutScale = atof(argv[++a]);
+		}
+		else if ((argument == "--bot" || argument == "--single-pod-bot") && a + 2 < argc)
+		{
+			const string name = argv[a + 1];
+			const string command = argv[a + 2];
+			bots.push_back({ name, command, argument == "--single-pod-bot" });
+			a += 2;
+		}
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+	if (bots.size() < 2 || gameCount < 1)
+	{
+		fprintf(stderr, "usage: %s [--games N] [--jobs J] [--seed S] [--laps N] [--timeout-scale F] --bot NAME \"COMMAND\" --single-pod-bot NAME \"COMMAND\" ...\n", argv[0]);
+		return 2;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	Tournament tournament(bots, seed, laps, timeoutScale);
+	const auto start = chrono::steady_clock::now();
+	tournament.Run(gameCount, jobs);
+	const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	tournament.Report(seconds, jobs);
+	return 0;
+}
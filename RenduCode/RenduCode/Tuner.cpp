@@ -0,0 +1,314 @@
+//Tuner: SPSA tuning of the run-time parameters of a bot (see the Parameters region of the bots) by self-play.
+//Every iteration perturbs all the parameters at once in a random direction, plays the two opposite perturbations against each other
+//on random tracks, several games at a time, and moves the parameters towards the winner in proportion to the score difference.
+//The parameters are exported after every iteration as a header that replaces the defaults of the bot: g++ -include TunedParameters.h GoldToLegend.cpp
+//POSIX only. Build: g++ -std=c++17 -O2 -pthread Tuner.cpp -o tuner
+//Usage: tuner [--iterations N] [--games G] [--jobs J] [--seed S] [--laps N] [--timeout-scale F] [--single-pod] [--tune NAME]... [--output FILE] "COMMAND"
+//All the parameters listed by "COMMAND --list-parameters" are tuned unless some are chosen with --tune
+#define REFEREE_NO_MAIN
+#include "Referee.cpp"
+
+#define SPSA_ALPHA 0.602 //decay of the step size
+#define SPSA_GAMMA 0.101 //decay of the perturbation size
+#define SPSA_PERTURBATION 0.1 //first perturbation, as a share of the range of each parameter
+#define SPSA_STEP 0.05 //first move for a full score difference, as a share of the range of each parameter
+
+struct TunedParameter
+{
+	string name;
+	double value; //the value listed by the bot, kept for the parameters that are not tuned
+	double minimum;
+	double maximum;
+	bool isInteger;
+	bool isTuned;
+};
+
+class Tuner
+{
+private:
+	string m_command;
+	bool m_isSinglePod;
+	vector<TunedParameter> m_parameters;
+	vector<double> m_positions; //position of each parameter in its range, between 0 and 1
+	unsigned int m_seed;
+	int m_laps;
+	double m_timeoutScale;
+	int m_jobs;
+public:
+	Tuner(const string& _command, bool _isSinglePod, unsigned int _seed, int _laps, double _timeoutScale, int _jobs);
+	bool LoadParameters(const vector<string>& _tunedNames);
+	void Run(int _iterations, int _games, const string& _output);
+
+private:
+	double GetValue(int _i, double _position) const;
+	string GetCommand(const vector<double>& _positions) const;
+	double PlayGames(const string& _commandA, const string& _commandB, int _games, unsigned int _firstSeed, int& _failures) const;
+	bool Export(const string& _path, int _iterations, int _games) const;
+};
+
+Tuner::Tuner(const string& _command, bool _isSinglePod, unsigned int _seed, int _laps, double _timeoutScale, int _jobs)
+	: m_command(_command), m_isSinglePod(_isSinglePod), m_seed(_seed), m_laps(_laps), m_timeoutScale(_timeoutScale), m_jobs(_jobs)
+{
+}
+
+//the bot lists its parameters with their current value and range
+bool Tuner::LoadParameters(const vector<string>& _tunedNames)
+{
+	const string command = m_command + " --list-parameters";
+	FILE* pipe = popen(command.c_str(), "r");
+	if (pipe == nullptr)
+	{
+		return false;
+	}
+	char line[512];
+	while (fgets(line, sizeof(line), pipe) != nullptr)
+	{
+		char name[128];
+		TunedParameter parameter;
+		int isInteger;
+		if (sscanf(line, "parameter name=%127s value=%lf minimum=%lf maximum=%lf integer=%d",
+			name, &parameter.value, &parameter.minimum, &parameter.maximum, &isInteger) != 5)
+		{
+			continue;
+		}
+		parameter.name = name;
+		parameter.isInteger = isInteger != 0;
+		parameter.isTuned = (_tunedNames.empty() || find(_tunedNames.begin(), _tunedNames.end(), parameter.name) != _tunedNames.end())
+			&& parameter.maximum > parameter.minimum;
+		m_parameters.push_back(parameter);
+		m_positions.push_back((parameter.value - parameter.minimum) / max(parameter.maximum - parameter.minimum, 1e-9));
+	}
+	pclose(pipe);
+	for (const string& name : _tunedNames)
+	{
+		if (none_of(m_parameters.begin(), m_parameters.end(), [&name](const TunedParameter& p) { return p.name == name; }))
+		{
+			fprintf(stderr, "unknown parameter %s\n", name.c_str());
+			return false;
+		}
+	}
+	return any_of(m_parameters.begin(), m_parameters.end(), [](const TunedParameter& p) { return p.isTuned; });
+}
+
+double Tuner::GetValue(int _i, double _position) const
+{
+	const TunedParameter& parameter = m_parameters[_i];
+	if (!parameter.isTuned)
+	{
+		return parameter.value;
+	}
+	const double value = parameter.minimum + clamp(_position, 0.0, 1.0) * (parameter.maximum - parameter.minimum);
+	return parameter.isInteger ? round(value) : value;
+}
+
+string Tuner::GetCommand(const vector<double>& _positions) const
+{
+	string command = m_command;
+	char argument[192];
+	for (int i = 0; i < (int)m_parameters.size(); i++)
+	{
+		if (m_parameters[i].isTuned)
+		{
+			snprintf(argument, sizeof(argument), " --set %s=%.6g", m_parameters[i].name.c_str(), GetValue(i, _positions[i]));
+			command += argument;
+		}
+	}
+	return command;
+}
+
+//average score of A, a draw is half a win. Games 2k and 2k + 1 share the track of seed _firstSeed + k, with the sides swapped.
+//_failures counts the games lost by a timeout, an invalid output or a crash: their result says nothing about the parameters
+double Tuner::PlayGames(const string& _commandA, const string& _commandB, int _games, unsigned int _firstSeed, int& _failures) const
+{
+	vector<double> scores(_games);
+	atomic<int> nextGame{ 0 };
+	atomic<int> failures{ 0 };
+	auto worker = [&]()
+	{
+		for (int game = nextGame++; game < _games; game = nextGame++)
+		{
+			const int sideA = game % 2;
+			string commands[2];
+			commands[sideA] = _commandA;
+			commands[1 - sideA] = _commandB;
+			const bool isSinglePod[2] = { m_isSinglePod, m_isSinglePod };
+			Referee referee(Track::Random(_firstSeed + game / 2, m_laps), isSinglePod, m_timeoutScale);
+			const MatchResult result = referee.Play(commands, true, false);
+			scores[game] = result.winner == -1 ? 0.5 : (result.winner == sideA ? 1.0 : 0.0);
+			if (result.winner != -1 && result.reason != "finish" && result.reason != "checkpoint_timeout")
+			{
+				failures++;
+			}
+		}
+	};
+	vector<thread> workers;
+	for (int j = 0; j < m_jobs; j++)
+	{
+		workers.emplace_back(worker);
+	}
+	for (thread& thread : workers)
+	{
+		thread.join();
+	}
+	_failures = failures;
+	double total = 0.0;
+	for (double score : scores)
+	{
+		total += score;
+	}
+	return total / _games;
+}
+
+//gains of Spall: the perturbation decays slowly, the step decays faster and is damped for the first tenth of the iterations
+void Tuner::Run(int _iterations, int _games, const string& _output)
+{
+	const double stability = 0.1 * _iterations;
+	const double stepGain = SPSA_STEP * 2.0 * SPSA_PERTURBATION * pow(stability + 1.0, SPSA_ALPHA);
+	FastRandom random(m_seed);
+	for (int k = 0; k < _iterations; k++)
+	{
+		const double perturbation = SPSA_PERTURBATION / pow(k + 1.0, SPSA_GAMMA);
+		const double step = stepGain / pow(k + 1.0 + stability, SPSA_ALPHA);
+		vector<double> directions(m_parameters.size());
+		vector<double> plus(m_positions);
+		vector<double> minus(m_positions);
+		for (int i = 0; i < (int)m_parameters.size(); i++)
+		{
+			directions[i] = random.Range(0, 2) == 0 ? -1.0 : 1.0;
+			plus[i] = clamp(m_positions[i] + perturbation * directions[i], 0.0, 1.0);
+			minus[i] = clamp(m_positions[i] - perturbation * directions[i], 0.0, 1.0);
+		}
+		int failures;
+		const double score = PlayGames(GetCommand(plus), GetCommand(minus), _games, m_seed + k * _games / 2, failures);
+		//the gradient estimate of each parameter is the score difference over the distance between the two perturbations
+		const double difference = 2.0 * score - 1.0;
+		for (int i = 0; i < (int)m_parameters.size(); i++)
+		{
+			m_positions[i] = clamp(m_positions[i] + step * difference / (2.0 * perturbation * directions[i]), 0.0, 1.0);
+		}
+
+		printf("iteration index=%d score=%.3f failures=%d", k, score, failures);
+		for (int i = 0; i < (int)m_parameters.size(); i++)
+		{
+			if (m_parameters[i].isTuned)
+			{
+				printf(" %s=%.6g", m_parameters[i].name.c_str(), GetValue(i, m_positions[i]));
+			}
+		}
+		printf("\n");
+		fflush(stdout);
+		if (!Export(_output, k + 1, _games))
+		{
+			fprintf(stderr, "cannot write %s\n", _output.c_str());
+		}
+	}
+}
+
+bool Tuner::Export(const string& _path, int _iterations, int _games) const
+{
+	FILE* file = fopen(_path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	fprintf(file, "//Parameters of \"%s\" tuned by Tuner.cpp: %d iterations of %d games, seed %u\n", m_command.c_str(), _iterations, _games, m_seed);
+	fprintf(file, "//They replace the defaults of the bot when this header is included first: g++ -include %s\n", _path.c_str());
+	fprintf(file, "#pragma once\n");
+	for (int i = 0; i < (int)m_parameters.size(); i++)
+	{
+		const double value = GetValue(i, m_positions[i]);
+		if (m_parameters[i].isInteger)
+		{
+			fprintf(file, "#define %s %d\n", m_parameters[i].name.c_str(), (int)value);
+		}
+		else
+		{
+			//a float literal needs a decimal point before its suffix
+			char literal[64];
+			snprintf(literal, sizeof(literal), "%.6g", value);
+			fprintf(file, "#define %s %s%sf\n", m_parameters[i].name.c_str(), literal, strpbrk(literal, ".e") == nullptr ? ".0" : "");
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = 100;
+	int games = 16;
+	//a game runs 2 bots, and a bot can keep a core busy while its opponent thinks
+	int jobs = max(1, (int)thread::hardware_concurrency() / 2);
+	unsigned int seed = 1;
+	int laps = DEFAULT_LAPS;
+	double timeoutScale = 1.0;
+	bool isSinglePod = false;
+	vector<string> tunedNames;
+	string output = "TunedParameters.h";
+	string command;
+	for (int a = 1; a < argc; a++)
+	{
+		const string argument = argv[a];
+		if (argument == "--iterations" && a + 1 < argc)
+		{
+			iterations = atoi(argv[++a]);
+		}
+		else if (argument == "--games" && a + 1 < argc)
+		{
+			//games are played in pairs on the same track
+			games = max(2, (atoi(argv[++a]) + 1) / 2 * 2);
+		}
+		else if (argument == "--jobs" && a + 1 < argc)
+		{
+			jobs = max(1, atoi(argv[++a]));
+		}
+		else if (argument == "--seed" && a + 1 < argc)
+		{
+			seed = (unsigned int)strtoul(argv[++a], nullptr, 10);
+		}
+		else if (argument == "--laps" && a + 1 < argc)
+		{
+			laps = atoi(argv[++a]);
+		}
+		else if (argument == "--timeout-scale" && a + 1 < argc)
+		{
+			timeoutScale = atof(argv[++a]);
+		}
+		else if (argument == "--single-pod")
+		{
+			isSinglePod = true;
+		}
+		else if (argument == "--tune" && a + 1 < argc)
+		{
+			tunedNames.push_back(argv[++a]);
+		}
+		else if (argument == "--output" && a + 1 < argc)
+		{
+			output = argv[++a];
+		}
+		else if (command.empty() && argument.compare(0, 2, "--") != 0)
+		{
+			command = argument;
+		}
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+	if (command.empty() || iterations < 1)
+	{
+		fprintf(stderr, "usage: %s [--iterations N] [--games G] [--jobs J] [--seed S] [--laps N] [--timeout-scale F] [--single-pod] [--tune NAME]... [--output FILE] \"COMMAND\"\n", argv[0]);
+		return 2;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	Tuner tuner(command, isSinglePod, seed, laps, timeoutScale, jobs);
+	if (!tuner.LoadParameters(tunedNames))
+	{
+		fprintf(stderr, "no parameter to tune in \"%s --list-parameters\"\n", command.c_str());
+		return 1;
+	}
+	tuner.Run(iterations, games, output);
+	return 0;
+}
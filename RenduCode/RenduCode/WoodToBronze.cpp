@@ -2,9 +2,168 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cerrno>
+
+//the input and output go straight to the file descriptors, without iostream
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+#pragma region InputOutput
+inline long ReadDescriptor(int _fd, char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+    return _read(_fd, _buffer, (unsigned int)_size);
+#else
+    return (long)read(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+inline long WriteDescriptor(int _fd, const char* _buffer, int _size)
+{
+#ifdef _MSC_VER
+    return _write(_fd, _buffer, (unsigned int)_size);
+#else
+    return (long)write(_fd, _buffer, (size_t)_size);
+#endif
+}
+
+//the two lines of a turn of the single pod protocol
+struct TurnInput
+{
+    int x, y, nextCheckpointX, nextCheckpointY, nextCheckpointDist, nextCheckpointAngle;
+    int opponentX, opponentY;
+};
+
+//Reads the referee input in large blocks and parses the integers in place, with no locale and no stdio synchronization.
+//The input of a whole turn usually arrives with a single read
+class InputReader
+{
+private:
+    static constexpr int BUFFER_SIZE = 1 << 16;
+    int m_fd;
+    vector<char> m_buffer;
+    const char* m_current = nullptr;
+    const char* m_end = nullptr;
+
+    bool Refill();
+public:
+    InputReader(int _fd = 0) : m_fd(_fd), m_buffer(BUFFER_SIZE) {}
+    //false at the end of the input
+    bool ReadInt(int& _value);
+    bool ReadTurn(TurnInput& _turn);
+};
+
+bool InputReader::Refill()
+{
+    long size;
+    do
+    {
+        size = ReadDescriptor(m_fd, m_buffer.data(), BUFFER_SIZE);
+    } while (size < 0 && errno == EINTR);
+    if (size <= 0)
+    {
+        return false;
+    }
+    m_current = m_buffer.data();
+    m_end = m_current + size;
+    return true;
+}
+
+bool InputReader::ReadInt(int& _value)
+{
+    //skip the separators
+    while (true)
+    {
+        if (m_current == m_end && !Refill())
+        {
+            return false;
+        }
+        if (*m_current == '-' || (unsigned int)(*m_current - '0') < 10u)
+        {
+            break;
+        }
+        m_current++;
+    }
+    const bool isNegative = *m_current == '-';
+    m_current += isNegative;
+    //a number can be cut by the end of the buffer
+    int value = 0;
+    do
+    {
+        while (m_current < m_end && (unsigned int)(*m_current - '0') < 10u)
+        {
+            value = value * 10 + (*m_current++ - '0');
+        }
+    } while (m_current == m_end && Refill());
+    _value = isNegative ? -value : value;
+    return true;
+}
+
+bool InputReader::ReadTurn(TurnInput& _turn)
+{
+    return ReadInt(_turn.x) && ReadInt(_turn.y) && ReadInt(_turn.nextCheckpointX) && ReadInt(_turn.nextCheckpointY)
+        && ReadInt(_turn.nextCheckpointDist) && ReadInt(_turn.nextCheckpointAngle) && ReadInt(_turn.opponentX) && ReadInt(_turn.opponentY);
+}
+
+//The output of a turn is formatted in one buffer and sent with a single write on Flush
+class OutputWriter
+{
+private:
+    int m_fd;
+    string m_buffer;
+public:
+    OutputWriter(int _fd = 1) : m_fd(_fd) { m_buffer.reserve(256); }
+    void Write(const char* _text) { m_buffer += _text; }
+    void Write(char _c) { m_buffer += _c; }
+    void Write(int _value);
+    void Flush();
+};
+
+void OutputWriter::Write(int _value)
+{
+    char digits[12];
+    int count = 0;
+    unsigned int magnitude = _value < 0 ? 0u - (unsigned int)_value : (unsigned int)_value;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (_value < 0)
+    {
+        m_buffer += '-';
+    }
+    while (count > 0)
+    {
+        m_buffer += digits[--count];
+    }
+}
+
+void OutputWriter::Flush()
+{
+    int written = 0;
+    while (written < (int)m_buffer.size())
+    {
+        const long size = WriteDescriptor(m_fd, m_buffer.data() + written, (int)m_buffer.size() - written);
+        if (size < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (size <= 0)
+        {
+            break;
+        }
+        written += size;
+    }
+    m_buffer.clear();
+}
+#pragma endregion InputOutput
+
 /**
  * Auto-generated code below aims at helping you parse
  * the standard input according to the problem statement.
@@ -13,21 +172,18 @@ using namespace std;
 int main()
 {
 
+    InputReader input;
+    OutputWriter output;
+    TurnInput turn;
     // game loop
-    while (1) {
-        int x;
-        int y;
-        int nextCheckpointX; // x position of the next check point
-        int nextCheckpointY; // y position of the next check point
-        int nextCheckpointDist; // distance to the next checkpoint
-        int nextCheckpointAngle; // angle between your pod orientation and the direction of the next checkpoint
-        cin >> x >> y >> nextCheckpointX >> nextCheckpointY >> nextCheckpointDist >> nextCheckpointAngle; cin.ignore();
-        int opponentX;
-        int opponentY;
+    while (input.ReadTurn(turn)) {
+        int nextCheckpointX = turn.nextCheckpointX; // x position of the next check point
+        int nextCheckpointY = turn.nextCheckpointY; // y position of the next check point
+        int nextCheckpointDist = turn.nextCheckpointDist; // distance to the next checkpoint
+        int nextCheckpointAngle = turn.nextCheckpointAngle; // angle between your pod orientation and the direction of the next checkpoint
         int thrust;
         bool canBoost = true;
         bool isBoosting = false;
-        cin >> opponentX >> opponentY; cin.ignore();
 
         if (nextCheckpointAngle > -10 && nextCheckpointAngle < 10 && nextCheckpointDist > 5000 && canBoost == true)
         {
@@ -54,13 +210,19 @@ int main()
         // You have to output the target position
         // followed by the power (0 <= thrust <= 100)
         // i.e.: "x y thrust"
+        output.Write(nextCheckpointX);
+        output.Write(' ');
+        output.Write(nextCheckpointY);
+        output.Write(' ');
         if (isBoosting)
         {
-            cout << nextCheckpointX << " " << nextCheckpointY << " " << "BOOST" << endl;
+            output.Write("BOOST\n");
         }
         else
         {
-            cout << nextCheckpointX << " " << nextCheckpointY << " " << thrust << endl;
+            output.Write(thrust);
+            output.Write('\n');
         }
+        output.Flush();
     }
 }
\ No newline at end of file